@@ -83,10 +83,6 @@ int main(int argc, char** argv)
     auto vpkFS = std::make_shared<VpkFileSystem>(outVpk.generic_string());
     vpkFS->openPackage();
 
-    VUUIDResolver resolver {};
-    resolver.setScheme("res");
-    resolver.loadFromVPK(vpkFS->getVpk());
-
     vfilesystem::VirtualFileSystem vfs {};
     vfs.mount(vpkFS, "res");
 
@@ -136,38 +132,28 @@ int main(int argc, char** argv)
         auto baseColorTexRef = material.core.pbrMR.baseColorTexture;
         if (baseColorTexRef.uuid.valid())
         {
-            std::string baseColorTexPath;
-            if (resolver.resolve(baseColorTexRef.uuid, baseColorTexPath))
+            // Texture references are UUIDs: open them through the pack's UUID index, no path needed.
+            const std::string uuidStr = vbase::to_string(baseColorTexRef.uuid);
+            auto              r       = vpkFS->open(baseColorTexRef.uuid);
+            if (!r)
+            {
+                std::cerr << "Failed to open base color texture in VPK: " << uuidStr << std::endl;
+            }
+            else
             {
-                std::cout << "    Base Color Texture: " << baseColorTexPath << std::endl;
-                // Try load the texture from VPK
-                auto r = vfs.open(baseColorTexPath, vfilesystem::FileMode::eRead);
-                if (!r)
+                auto     vpkTexFile = std::move(r.value());
+                VTexture texture {};
+                auto     res = loadTextureFromMemory(vpkTexFile->readAllBytes(), texture);
+                if (res)
                 {
-                    std::cerr << "Failed to open base color texture in VPK: " << baseColorTexPath << std::endl;
+                    std::cout << "    Loaded base color texture from VPK: " << uuidStr << " (" << texture.width
+                              << "x" << texture.height << ")" << std::endl;
                 }
                 else
                 {
-                    auto     vpkTexFile = std::move(r.value());
-                    VTexture texture {};
-                    auto     res = loadTextureFromMemory(vpkTexFile->readAllBytes(), texture);
-                    if (res)
-                    {
-                        std::cout << "    Loaded base color texture from VPK: " << baseColorTexPath << " ("
-                                  << texture.width << "x" << texture.height << ")" << std::endl;
-                    }
-                    else
-                    {
-                        std::cerr << "Failed to load base color texture from VPK memory: " << baseColorTexPath
-                                  << std::endl;
-                    }
+                    std::cerr << "Failed to load base color texture from VPK memory: " << uuidStr << std::endl;
                 }
             }
-            else
-            {
-                std::cout << "    Base Color Texture UUID not found in resolver: "
-                          << vbase::to_string(baseColorTexRef.uuid) << std::endl;
-            }
         }
     }
 
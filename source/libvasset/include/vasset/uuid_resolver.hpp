@@ -43,13 +43,14 @@ namespace vasset
         {
             clear();
 
+            std::string scratch;
             for (const auto& r : vpk.registry)
             {
-                if (r.pathOffset + r.pathSize > vpk.stringTable.size())
+                const std::string_view path = vpkPathOf(vpk, r, scratch);
+                if (path.size() != r.pathSize)
                     continue;
 
-                const char* s = vpk.stringTable.data() + r.pathOffset;
-                registerAsset(r.uuid, vbase::StringView(s, r.pathSize));
+                registerAsset(r.uuid, vbase::StringView(path.data(), path.size()));
             }
         }
 
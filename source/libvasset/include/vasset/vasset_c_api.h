@@ -12,7 +12,9 @@
 //   - Getter functions returning `const char*` return a thread-local buffer valid only until the
 //     next call to the SAME function on the same thread; copy it out before calling again.
 //   - Handle-returning constructors return NULL on failure (with vasset_last_error set).
-//   - Object handles are not thread-safe; do not share one handle across threads concurrently.
+//   - Object handles are not thread-safe; do not share one handle across threads concurrently. The
+//     exception is a VPK handle after open: vasset_vpk_read/stat and the vasset_vpk_* getters may be
+//     called from many threads at once (reads use positional I/O on one shared descriptor).
 #ifndef VASSET_C_API_H
 #define VASSET_C_API_H
 
@@ -71,8 +73,46 @@ extern "C"
     // (free with vasset_blob_free) and returns VASSET_OK; negative on failure.
     int32_t vasset_vpk_read(VAssetVpkHandle vpk, const char* logicalPath, VAssetBlob* outBlob);
 
+    // As vasset_vpk_read, addressed by asset UUID (32-char hex, as vasset_vpk_asset_uuid_at returns).
+    // The pack's UUID index is searched directly; no logical path is built or hashed.
+    int32_t vasset_vpk_read_uuid(VAssetVpkHandle vpk, const char* uuid, VAssetBlob* outBlob);
+
+    // Read many payloads in one call: reads are sorted by file offset, neighbouring ranges merged into
+    // large sequential reads, and entries decompressed in parallel. outBlobs[i] (and outStatus[i] when
+    // outStatus is non-NULL) belong to logicalPaths[i]; a failed entry gets an empty blob and a
+    // negative status. Free every filled blob with vasset_blob_free. Returns VASSET_OK when all entries
+    // were read, otherwise the first failing status.
+    int32_t vasset_vpk_read_batch(VAssetVpkHandle    vpk,
+                                  const char* const* logicalPaths,
+                                  size_t             count,
+                                  VAssetBlob*        outBlobs,
+                                  int32_t*           outStatus);
+
+    // Index-only metadata for one entry; no payload is read or decompressed. Out pointers may be NULL.
+    // compression is 0 (stored), 1 (zstd), 2 (seekable zstd frames) or 3 (lz4). Returns VASSET_OK, or negative
+    // when the path is absent.
+    int32_t vasset_vpk_stat(VAssetVpkHandle vpk,
+                            const char*     logicalPath,
+                            uint64_t*       outRawSize,
+                            uint64_t*       outPackedSize,
+                            int32_t*        outCompression);
+
     uint32_t vasset_vpk_file_count(VAssetVpkHandle vpk);
 
+    // Directory tree of the package; dirPath "" or "/" is the root. Returns 1/0.
+    int32_t vasset_vpk_is_directory(VAssetVpkHandle vpk, const char* dirPath);
+
+    // Snapshot of one directory's immediate children: subdirectories first, then files, each sorted by
+    // name. The listing owns its names and outlives the VPK handle. NULL when dirPath is not a
+    // directory. Free with vasset_vpk_listing_destroy.
+    typedef struct VAssetVpkListing_t* VAssetVpkListingHandle;
+
+    VAssetVpkListingHandle vasset_vpk_list_directory(VAssetVpkHandle vpk, const char* dirPath);
+    void                   vasset_vpk_listing_destroy(VAssetVpkListingHandle listing);
+    uint32_t               vasset_vpk_listing_count(VAssetVpkListingHandle listing);
+    const char*            vasset_vpk_listing_name_at(VAssetVpkListingHandle listing, uint32_t index); // "" oob
+    int32_t vasset_vpk_listing_is_directory_at(VAssetVpkListingHandle listing, uint32_t index);      // 1/0
+
     // Registry (uuid <-> logical path + type) embedded in the VPK.
     uint32_t    vasset_vpk_asset_count(VAssetVpkHandle vpk);
     const char* vasset_vpk_asset_uuid_at(VAssetVpkHandle vpk, uint32_t index); // 32-char hex, "" oob
@@ -172,6 +212,22 @@ extern "C"
     VAssetPackOptionsHandle vasset_pack_options_create(void);
     void                    vasset_pack_options_destroy(VAssetPackOptionsHandle options);
     void                    vasset_pack_options_set_zstd_level(VAssetPackOptionsHandle options, int32_t level);
+    // Compression workers; 0 (the default) = hardware concurrency. Output does not depend on it.
+    void vasset_pack_options_set_threads(VAssetPackOptionsHandle options, uint32_t threads);
+    // Start every payload on a multiple of `alignment` bytes (a power of two; 1, the default, packs
+    // them back to back). 4096 allows O_DIRECT reads and page-shared mappings.
+    void vasset_pack_options_set_alignment(VAssetPackOptionsHandle options, uint32_t alignment);
+    // 0 (the default) compresses with zstd, 1 with LZ4, 2 picks per entry between zstd, LZ4 and stored
+    // by estimated load time (see VpkCodecCostModel).
+    void vasset_pack_options_set_codec(VAssetPackOptionsHandle options, int32_t codec);
+    // Non-zero stores the package's paths front-coded, which shrinks the resident index of packs with
+    // many paths under shared prefixes.
+    void vasset_pack_options_set_front_coded_paths(VAssetPackOptionsHandle options, int32_t enabled);
+    // Split the payloads into volume files "<out.vpk>.000", ".001", ... of at most `bytes` each, next
+    // to the package file that indexes them. 0 (the default) writes a single file.
+    void vasset_pack_options_set_volume_size(VAssetPackOptionsHandle options, uint64_t bytes);
+    // Lay out assets recorded in this access trace first, in first-access order (repeatable).
+    void vasset_pack_options_add_layout_trace(VAssetPackOptionsHandle options, const char* tracePath);
     void                    vasset_pack_options_add_include_path(VAssetPackOptionsHandle options, const char* path);
     void                    vasset_pack_options_add_root_path(VAssetPackOptionsHandle options, const char* path);
     // Pack a physical dir verbatim under logicalPrefix; subsequent add_extra_exclude calls attach to
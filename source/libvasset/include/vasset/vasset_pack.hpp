@@ -2,6 +2,7 @@
 
 #include "vasset/asset_error.hpp"
 #include "vasset/vasset_importers.hpp"
+#include "vasset/vpk.hpp"
 
 #include <vbase/core/result.hpp>
 #include <vbase/core/string_view.hpp>
@@ -35,9 +36,18 @@ namespace vasset
     struct VpkPackOptions
     {
         int                      zstdLevel {6};
+        uint32_t                 threads {0};          // compression workers; 0 = hardware concurrency
+        uint32_t                 payloadAlignment {1}; // power of two; see VpkWriteOptions::payloadAlignment
+        VpkCodec                 codec {VpkCodec::eZstd};
+        bool                     frontCodedPaths {false}; // see VpkWriteOptions::frontCodedPaths
+        uint64_t                 volumeSize {0};          // see VpkWriteOptions::volumeSize
         std::vector<std::string> includePaths;
         std::vector<std::string> rootPaths;
         std::vector<VpkExtraDir> extraDirs;
+
+        // Access traces recorded with VpkFileSystem::beginTrace. Traced assets are laid out first, in
+        // first-access order (see readVpkAccessTraces); the rest follow in dependency order.
+        std::vector<std::string> layoutTraces;
     };
 
     // Match a relative path (forward slashes) against a glob. `*` matches any run of non-`/`
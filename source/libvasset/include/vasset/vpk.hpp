@@ -12,9 +12,13 @@
 #include <vbase/core/uuid.hpp>
 
 #include <cstdint>
+#include <future>
+#include <map>
 #include <memory>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace vasset
@@ -26,13 +30,21 @@ namespace vasset
     // - Data is typically the cooked asset bytes (e.g. .vtex / .vmesh).
     // - Per-entry compression is supported. Already-compressed assets should be stored uncompressed.
     //
-    // File layout (v2):
-    // [Header][Index][StringTable][AssetRegistry][DataBlob]
+    // File layout (v4):
+    // [Header][DataBlob][StringTable][Index][AssetRegistry][Section payloads][SectionTable]
+    //
+    // Multi-volume packs (kVpkFlagVolumes) keep the payloads out of that file, in numbered volumes
+    // next to it (see vpkVolumePath); their data blob is empty. zstd dictionaries are section payloads
+    // in every layout, so they always stay in the main file.
+    //
+    // v4 appends a table of typed sections to the v3 layout. Readers skip section kinds they do not
+    // know, so new optional data can be added without another version bump. The index, registry and
+    // section tables start on 8-byte boundaries so a mapped image can be used in place.
     struct VpkHeader
     {
         char     magic[4]; // "VPK\0"
-        uint32_t version;  // 2
-        uint32_t flags;    // reserved
+        uint32_t version;  // 4
+        uint32_t flags;    // kVpkFlag*
         uint32_t fileCount;
 
         uint64_t indexOffset;
@@ -47,12 +59,86 @@ namespace vasset
         uint32_t paddingU0;
 
         uint64_t dataOffset;
+
+        // v4+: VpkSection table (zero for older packs).
+        uint64_t sectionOffset;
+        uint32_t sectionCount;
+        uint32_t paddingU1;
+    };
+
+    // The index is sorted by pathHash64, so lookups binary-search it where it lies.
+    constexpr uint32_t kVpkFlagSortedIndex = 1u << 0;
+
+    // A patch package (writeVpkPatch): it holds only the entries that changed relative to a base
+    // package, plus tombstones for removed paths, and is meant to be mounted over that base
+    // (VpkOverlayFileSystem).
+    constexpr uint32_t kVpkFlagPatch = 1u << 1;
+
+    // Paths are front-coded (VpkWriteOptions::frontCodedPaths): sorted, grouped into buckets of
+    // kVpkPathBucketSize and stored as (shared prefix, suffix) pairs in an ePathBuckets section. Entry
+    // and registry pathOffsets then hold the path's rank in that order, and the string table keeps only
+    // directory names. Read paths through vpkPathOf.
+    constexpr uint32_t kVpkFlagFrontCodedPaths = 1u << 2;
+    constexpr uint32_t kVpkPathBucketSize      = 16;
+
+    // Payloads live in volume files (VpkWriteOptions::volumeSize): VpkEntry::volume names the file
+    // and dataOffset is relative to it. An eVolumes section records each volume's size. Dictionaries
+    // and tables stay in the main file, which readers open first; volumes are opened on first use.
+    constexpr uint32_t kVpkFlagVolumes = 1u << 3;
+
+    // Volume count limit. Entry caches key a payload by (volume << 48 | offset).
+    constexpr uint32_t kVpkMaxVolumes = 1u << 16;
+
+    // Bits 8..12 hold log2 of the alignment every non-empty payload starts on (VpkWriteOptions::
+    // payloadAlignment); 0 means none is promised. openVpk rejects packs that break the promise.
+    constexpr uint32_t kVpkFlagAlignmentShift = 8;
+    constexpr uint32_t kVpkFlagAlignmentMask  = 0x1Fu << kVpkFlagAlignmentShift;
+
+    // The payload alignment a package guarantees, in bytes (1 when none).
+    constexpr uint64_t vpkPayloadAlignment(const VpkHeader& header)
+    {
+        return uint64_t {1} << ((header.flags & kVpkFlagAlignmentMask) >> kVpkFlagAlignmentShift);
+    }
+
+    // VpkEntry::flags. A tombstone marks a path removed by a patch package; it has no payload and
+    // readers of the package itself treat the path as absent.
+    constexpr uint8_t kVpkEntryFlagTombstone = 1u << 0;
+
+    enum class VpkSectionKind : uint32_t
+    {
+        eDictionaries = 1, // VpkDictionaryEntry[count]
+        eDirectories  = 2, // VpkDirectoryNode[count], then uint32_t fileOrder[header.fileCount]
+        eChecksums    = 3, // uint64_t XXH3-64 of each entry's raw bytes, in index order; count = fileCount
+        eDependencies = 4, // VpkDependencyRange[count = registryCount], then uint32_t targets[] (registry indices)
+        eUuidIndex    = 5, // VpkUuidIndexEntry[count], sorted by UUID bytes
+        ePathBuckets  = 6, // uint32_t bucketOffsets[count], then the front-coded buckets (kVpkFlagFrontCodedPaths)
+        eVolumes      = 7, // uint64_t volumeSizes[count] (kVpkFlagVolumes)
+    };
+
+    struct VpkSection
+    {
+        VpkSectionKind kind {VpkSectionKind::eDictionaries};
+        uint32_t       count {0}; // element count, meaning depends on kind
+        uint64_t       offset {0};
+        uint64_t       size {0};
+    };
+
+    // A zstd dictionary trained at pack time for one asset type. Entries compressed against it name
+    // it through VpkEntry::dictionary.
+    struct VpkDictionaryEntry
+    {
+        uint64_t   offset    = 0; // absolute file offset of the dictionary bytes
+        uint64_t   size      = 0;
+        VAssetType type      = VAssetType::eUnknown;
+        uint32_t   reserved0 = 0;
     };
 
     enum class VpkCompression : uint8_t
     {
-        eNone = 0,
-        eZstd = 1,
+        eNone       = 0,
+        eZstd       = 1,
+        eZstdFrames = 2, // independently compressed fixed-size frames behind a seek table
+        eLz4        = 3, // one LZ4 block; decodes several times faster than zstd at a lower ratio
     };
 
     struct VpkAssetRegistryEntry
@@ -64,40 +150,270 @@ namespace vasset
         uint32_t    reserved0  = 0;
     };
 
+    // One directory of the package tree. Node 0 is the root; nodes are numbered breadth-first so each
+    // node's subdirectories are a contiguous, name-sorted run. `fileOrder` in the same section lists
+    // index positions grouped per directory and sorted by name. Names are slices of entry paths in
+    // the string table, so the tree adds no string bytes.
+    struct VpkDirectoryNode
+    {
+        uint32_t nameOffset = 0; // last path component (empty for the root)
+        uint32_t nameSize   = 0;
+        uint32_t firstDir   = 0; // subdirectories: nodes [firstDir, firstDir + dirCount)
+        uint32_t dirCount   = 0;
+        uint32_t firstFile  = 0; // files: fileOrder [firstFile, firstFile + fileCount)
+        uint32_t fileCount  = 0;
+    };
+
+    // Dependency graph over the registry: registry entry i depends on the registry entries
+    // targets[first, first + count). Only edges between packed assets are kept.
+    struct VpkDependencyRange
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    // Direct UUID lookup: one row per registered asset, so a UUID reference reaches its index entry by
+    // binary search without building or hashing a path.
+    struct VpkUuidIndexEntry
+    {
+        vbase::UUID uuid;
+        uint32_t    entry    = 0; // position in the index
+        uint32_t    registry = 0; // position in the registry
+    };
+
     struct VpkEntry
     {
         uint64_t       pathHash64  = 0;
-        uint32_t       pathOffset  = 0; // offset into string table
+        uint32_t       pathOffset  = 0; // offset into string table (path rank when front-coded)
         uint32_t       pathSize    = 0; // bytes (not including null)
-        uint64_t       dataOffset  = 0; // absolute file offset
+        uint64_t       dataOffset  = 0; // absolute offset in its file; deduplicated entries share a payload
         uint64_t       packedSize  = 0;
         uint64_t       rawSize     = 0;
         VpkCompression compression = VpkCompression::eNone;
+        uint8_t        dictionary  = 0; // v4+: 1-based index into the dictionary section, 0 = none
+        uint8_t        flags       = 0; // kVpkEntryFlag*
+        uint8_t        reserved0   = 0;
+        uint32_t       volume      = 0; // kVpkFlagVolumes: the volume file holding the payload
     };
 
+    // The index is read and written as raw records; v2/v3 packs used the same 48 bytes, with the
+    // fields after `compression` as padding.
+    static_assert(sizeof(VpkEntry) == 48, "VpkEntry must keep its 48-byte on-disk layout");
+
+    class VpkFileHandle;
+    class VpkDictionaries;
+    class VpkPathNames;
+    class VpkVolumes;
+
+    // A parsed package. Immutable after open: any number of threads may read entries from one
+    // VpkReadOnly concurrently (disk-backed packs share a single positional-read handle).
+    //
+    // The tables are views. For v4 images opened in place they point straight into the image;
+    // otherwise into buffers held by `storage`. `entries` is always sorted by pathHash64.
     struct VpkReadOnly
     {
-        VpkHeader                                           header {};
-        std::vector<VpkAssetRegistryEntry>                  registry;
-        std::vector<VpkEntry>                               entries;
-        std::string                                         stringTable;
-        std::unordered_map<uint64_t, std::vector<uint32_t>> buckets; // hash -> entry indices
+        VpkHeader                              header {};
+        std::span<const VpkAssetRegistryEntry> registry;
+        std::span<const VpkEntry>              entries;
+        std::string_view                       stringTable;
+        std::span<const VpkSection>            sections;
+        std::span<const VpkDirectoryNode>      directories;    // empty for packs written before the tree
+        std::span<const uint32_t>              directoryFiles; // index positions, see VpkDirectoryNode
+        std::span<const uint64_t>              checksums;      // per index entry; empty for packs without
+        std::span<const VpkDependencyRange>    dependencies;   // per registry entry; empty without a graph
+        std::span<const uint32_t>              dependencyTargets; // registry indices
+        std::span<const VpkUuidIndexEntry>     uuidIndex;      // empty for packs written before it
+        std::span<const uint32_t>              pathBuckets;    // front-coded packs: bucket offsets into pathData
+        std::span<const std::byte>             pathData;       // front-coded packs: the path buckets
+        std::shared_ptr<VpkPathNames>          pathNames;      // front-coded packs: paths decoded for listings
+        std::span<const uint64_t>              volumeSizes;    // multi-volume packs: bytes per volume
+        std::shared_ptr<const VpkVolumes>      volumes;        // multi-volume packs from openVpk: lazy handles
+        std::shared_ptr<const VpkDictionaries> dictionaries;   // decoder-ready, built at open
+        std::shared_ptr<const void>            storage;      // keeps the tables above alive
+        std::shared_ptr<const VpkFileHandle>   file;         // set by openVpk; null for memory packs
+
+        // Check each whole-entry read (readVpkFile*, batched reads, decoded VpkFileSystem opens)
+        // against its stored checksum; a mismatch fails with eInvalidFormat. Entries of packs without
+        // checksums are not checked.
+        bool verifyOnRead {false};
     };
 
-    // Open and parse a VPK file.
+    // Index metadata for one entry, answered without touching its payload.
+    struct VpkFileStat
+    {
+        uint64_t       rawSize {0};
+        uint64_t       packedSize {0};
+        VpkCompression compression {VpkCompression::eNone};
+    };
+
+    // Open and parse a VPK file. The volumes of a multi-volume pack are looked up next to it and
+    // opened when an entry in them is first read.
     vbase::Result<VpkReadOnly, AssetError> openVpk(vbase::StringView vpkPath);
 
-    // Open and parse a VPK from an in-memory blob (e.g. a binary embedded into the executable).
+    // Open and parse a VPK from an in-memory blob (e.g. a binary embedded into the executable). The
+    // tables are copied, so `blob` need not outlive the result. Entries of a multi-volume pack opened
+    // this way (or through openVpkFromImage) cannot be read: there is no path to find the volumes by,
+    // so the *FromMemory reads fail with eNotSupported.
     vbase::Result<VpkReadOnly, AssetError> openVpkFromMemory(vbase::ConstByteSpan blob);
 
-    // Read an entry payload by logical path.
+    // Open a VPK image (mapping or owned blob) in place. For v4 packs the tables alias `image` and
+    // nothing is copied, sorted or hashed: open cost is independent of the entry count. `owner` is
+    // retained to keep the image alive. Older layouts fall back to copying.
+    vbase::Result<VpkReadOnly, AssetError> openVpkFromImage(std::shared_ptr<const void> owner,
+                                                            vbase::ConstByteSpan        image);
+
+    // File name of volume `index` of the pack at `vpkPath`: "<vpkPath>.000", "<vpkPath>.001", ...
+    std::string vpkVolumePath(vbase::StringView vpkPath, uint32_t index);
+
+    // The logical path of an index entry or registry record. Plain string tables hand out a view into
+    // the table; front-coded ones (kVpkFlagFrontCodedPaths) decode only the path's bucket into `scratch`
+    // and return a view of it. Empty when the record is out of range.
+    std::string_view vpkPathOf(const VpkReadOnly& vpk, const VpkEntry& e, std::string& scratch);
+    std::string_view vpkPathOf(const VpkReadOnly& vpk, const VpkAssetRegistryEntry& r, std::string& scratch);
+
+    // Look up an entry by logical path by binary search over the sorted index (a leading '/' is
+    // ignored). Returns nullptr when the path is not in the package or is a tombstone. Never reads
+    // payload data.
+    const VpkEntry* findVpkEntry(const VpkReadOnly& vpk, vbase::StringView logicalPath);
+
+    // As findVpkEntry, but also returns tombstones (check kVpkEntryFlagTombstone), for callers that
+    // layer patch packages over a base.
+    const VpkEntry* findVpkEntryOrTombstone(const VpkReadOnly& vpk, vbase::StringView logicalPath);
+
+    // Look up an entry by asset UUID through the UUID index (binary search, no path hashing). Packs
+    // without one fall back to scanning the registry. Returns nullptr when the UUID is not packed.
+    const VpkEntry* findVpkEntryByUuid(const VpkReadOnly& vpk, const vbase::UUID& uuid);
+
+    // Registry position of `uuid`, or UINT32_MAX when it is not registered. Same lookup as
+    // findVpkEntryByUuid.
+    uint32_t findVpkRegistryIndex(const VpkReadOnly& vpk, const vbase::UUID& uuid);
+
+    // One child of a listed directory.
+    struct VpkListEntry
+    {
+        std::string_view name; // last path component; aliases the package string table
+        bool             isDirectory {false};
+        const VpkEntry*  entry {nullptr}; // files only
+    };
+
+    // True when `dirPath` names a directory of the package ("" or "/" is the root). Leading and
+    // trailing '/' are ignored.
+    bool isVpkDirectory(const VpkReadOnly& vpk, vbase::StringView dirPath);
+
+    // Immediate children of a directory: subdirectories first, then files, each sorted by name.
+    // Walks the directory table (one binary search per path component); packs without one fall back
+    // to scanning the index. eNotFound when `dirPath` is not a directory.
+    vbase::Result<std::vector<VpkListEntry>, AssetError> listVpkDirectory(const VpkReadOnly& vpk,
+                                                                          vbase::StringView  dirPath);
+
+    // Index-only stat by logical path; eNotFound when absent.
+    vbase::Result<VpkFileStat, AssetError> statVpkFile(const VpkReadOnly& vpk, vbase::StringView logicalPath);
+
+    // Read an entry payload by logical path. Uses the package's shared handle when it has one (packs
+    // from openVpk); `vpkPath` is only opened for a VpkReadOnly without a handle. Thread-safe.
     vbase::Result<std::vector<std::byte>, AssetError>
     readVpkFile(const VpkReadOnly& vpk, vbase::StringView vpkPath, vbase::StringView logicalPath);
 
+    // readVpkFile / readVpkFileFromMemory addressed by asset UUID (see findVpkEntryByUuid).
+    vbase::Result<std::vector<std::byte>, AssetError>
+    readVpkFileByUuid(const VpkReadOnly& vpk, vbase::StringView vpkPath, const vbase::UUID& uuid);
+    vbase::Result<std::vector<std::byte>, AssetError>
+    readVpkFileFromMemoryByUuid(const VpkReadOnly& vpk, vbase::ConstByteSpan blob, const vbase::UUID& uuid);
+
+    // Registry indices of `root` and of every asset it reaches within `depth` dependency hops,
+    // breadth-first (root first, each once). Empty when `root` is not registered; just the root when
+    // the package has no dependency graph.
+    std::vector<uint32_t>
+    collectVpkDependencies(const VpkReadOnly& vpk, const vbase::UUID& root, uint32_t depth = UINT32_MAX);
+
+    struct VpkVerifyReport
+    {
+        size_t                   checked {0};    // entries decoded and matched against their checksum
+        size_t                   unverified {0}; // entries that decoded but have no stored checksum
+        std::vector<std::string> corrupt;        // paths that failed to read, decode or match, in index order
+    };
+
+    // Read, decode and checksum every entry of the package on `threads` workers (0 = hardware
+    // concurrency). Each worker walks a contiguous range of payloads in file order, and payloads shared
+    // by deduplicated entries are decoded once.
+    VpkVerifyReport verifyVpk(const VpkReadOnly& vpk, vbase::StringView vpkPath, uint32_t threads = 0);
+
+    struct VpkBatchReadOptions
+    {
+        uint32_t threads {0};             // decode workers; 0 = hardware concurrency
+        uint64_t maxGap {64u * 1024u};    // merge neighbouring ranges separated by at most this many bytes
+        uint64_t maxSpan {8ull << 20};    // upper bound on one merged read
+    };
+
+    // One result of a batched read: `bytes` is valid when `error` is eOk.
+    struct VpkBatchRead
+    {
+        AssetError             error {AssetError::eOk};
+        std::vector<std::byte> bytes;
+    };
+
+    // Read many entries at once; result i belongs to logicalPaths[i]. Reads are sorted by data
+    // offset and neighbouring ranges merged into large sequential reads, then decoded on a small
+    // worker pool. Missing paths yield eNotFound without failing the rest. Thread-safe like
+    // readVpkFile.
+    std::vector<VpkBatchRead> readVpkFiles(const VpkReadOnly&                 vpk,
+                                           vbase::StringView                  vpkPath,
+                                           std::span<const vbase::StringView> logicalPaths,
+                                           const VpkBatchReadOptions&         options = {});
+
+    // Batched read from an in-memory VPK blob (no I/O to merge; decoding runs in parallel).
+    std::vector<VpkBatchRead> readVpkFilesFromMemory(const VpkReadOnly&                 vpk,
+                                                     vbase::ConstByteSpan               blob,
+                                                     std::span<const vbase::StringView> logicalPaths,
+                                                     const VpkBatchReadOptions&         options = {});
+
     // Read an entry payload from an in-memory VPK blob.
     vbase::Result<std::vector<std::byte>, AssetError>
     readVpkFileFromMemory(const VpkReadOnly& vpk, vbase::ConstByteSpan blob, vbase::StringView logicalPath);
 
+    // Borrow an uncompressed entry's bytes straight out of an in-memory VPK image (blob or mapping),
+    // without copying. The span aliases `blob`. Compressed entries fail with eNotSupported; use
+    // readVpkFileFromMemory for those.
+    vbase::Result<vbase::ConstByteSpan, AssetError>
+    viewVpkFileFromMemory(const VpkReadOnly& vpk, vbase::ConstByteSpan blob, vbase::StringView logicalPath);
+
+    // readVpkFile / readVpkFileFromMemory into a caller-owned buffer. `out` is resized to the entry's
+    // raw size and keeps its capacity, so a streaming loop holding one buffer per worker allocates only
+    // when an entry outgrows it. The contents of `out` are unspecified on failure.
+    vbase::Result<void, AssetError> readVpkFileInto(const VpkReadOnly&      vpk,
+                                                    vbase::StringView       vpkPath,
+                                                    vbase::StringView       logicalPath,
+                                                    std::vector<std::byte>& out);
+    vbase::Result<void, AssetError> readVpkFileFromMemoryInto(const VpkReadOnly&      vpk,
+                                                              vbase::ConstByteSpan    blob,
+                                                              vbase::StringView       logicalPath,
+                                                              std::vector<std::byte>& out);
+
+    // A read-only memory mapping of an on-disk VPK. Held by shared_ptr so files/views borrowed from
+    // it can outlive the filesystem that created the mapping.
+    class VpkMapping final
+    {
+    public:
+        VpkMapping() = default;
+        ~VpkMapping();
+
+        VpkMapping(const VpkMapping&)            = delete;
+        VpkMapping& operator=(const VpkMapping&) = delete;
+
+        vbase::ConstByteSpan bytes() const { return {m_Data, m_Size}; }
+
+    private:
+        friend vbase::Result<std::shared_ptr<const VpkMapping>, AssetError> mapVpk(vbase::StringView vpkPath);
+
+        const std::byte* m_Data {nullptr};
+        size_t           m_Size {0};
+        void*            m_MappingHandle {nullptr}; // Win32 file-mapping object (unused on POSIX)
+    };
+
+    // Map a VPK file read-only into memory (mmap / MapViewOfFile). The whole file is mapped once;
+    // pages are faulted in on first touch.
+    vbase::Result<std::shared_ptr<const VpkMapping>, AssetError> mapVpk(vbase::StringView vpkPath);
+
     // Writer input: already-prepared cooked bytes for each logical path.
     struct VpkWriteItem
     {
@@ -106,39 +422,356 @@ namespace vasset
         std::string            logicalPath;
         std::vector<std::byte> bytes;
         bool                   allowCompress = true;
+
+        // Assets this one loads (material textures, skeletons, ...), recorded as the pack's
+        // eDependencies section. UUIDs that are not packed are dropped.
+        std::vector<vbase::UUID> dependencies;
+    };
+
+    // How VpkWriter compresses entries that may be compressed (see VpkWriteItem::allowCompress).
+    enum class VpkCodec : uint8_t
+    {
+        eZstd,     // always zstd (with the type's dictionary when one pays off)
+        eLz4,      // always LZ4
+        eAdaptive, // per entry, the cheapest of zstd, LZ4 and stored under VpkCodecCostModel
+    };
+
+    // Adaptive codec selection estimates the time to load an entry as
+    //   packedSize / readBytesPerSecond + rawSize / <codec>DecodeBytesPerSecond
+    // (stored entries only pay the read) and keeps the cheapest encoding. Rates describe one core of
+    // the target device: a faster read rate favours fast decoders, a slower one favours ratio.
+    struct VpkCodecCostModel
+    {
+        double readBytesPerSecond {400.0e6};
+        double zstdDecodeBytesPerSecond {500.0e6};
+        double lz4DecodeBytesPerSecond {2000.0e6};
+    };
+
+    struct VpkWriteOptions
+    {
+        int zstdLevel {3};
+
+        // Entries large enough to be framed (see framedThreshold) are framed zstd under every codec.
+        VpkCodec          codec {VpkCodec::eZstd};
+        int               lz4Level {0}; // 0 = LZ4 fast; 1..12 = LZ4HC level
+        VpkCodecCostModel costModel;
+
+        // Compressed entries of at least this many raw bytes are stored as eZstdFrames: frames of
+        // `frameSize` raw bytes compressed independently, preceded by a seek table, so a reader can
+        // decode a sub-range without inflating the whole entry. 0 disables framing.
+        uint64_t framedThreshold {4ull << 20};
+        uint32_t frameSize {256u * 1024u};
+
+        // Train one zstd dictionary per VAssetType from that type's small entries (raw size up to
+        // dictionaryMaxEntrySize) and compress them against it. A dictionary is only kept when it
+        // shrinks its entries by more than its own size.
+        bool     trainDictionaries {true};
+        uint32_t dictionaryMaxEntrySize {16u * 1024u};
+        uint32_t dictionaryCapacity {64u * 1024u};
+
+        // Compression workers; 0 = hardware concurrency. The output is byte-identical for any count.
+        uint32_t threads {0};
+
+        // Set kVpkFlagPatch in the header (writeVpkPatch sets it).
+        bool patch {false};
+
+        // Start every non-empty payload on a multiple of this many bytes (a power of two, e.g. 16 for
+        // SIMD copies, 4096 for O_DIRECT reads and page-shared mappings). It is recorded in the header
+        // flags. `typeAlignment` raises it for individual asset types; those are not recorded, since
+        // readers only rely on the pack-wide value. Padding is zero-filled.
+        uint32_t                       payloadAlignment {1};
+        std::map<VAssetType, uint32_t> typeAlignment;
+
+        // Write an eChecksums section (XXH3-64 of every entry's raw bytes).
+        bool checksums {true};
+
+        // Front-code the path table (kVpkFlagFrontCodedPaths). Paths that share long prefixes shrink
+        // several times over, at the cost of decoding one bucket per path compare.
+        bool frontCodedPaths {false};
+
+        // Split the payloads into volume files of at most this many bytes (kVpkFlagVolumes), e.g. to
+        // fit distribution or filesystem size limits or to spread a pack over several devices. A
+        // payload is never split, so one larger than this gets a volume of its own. 0 = single file.
+        uint64_t volumeSize {0};
+
+        // Store identical payloads once: entries whose raw bytes have the same XXH3-128 hash point at
+        // the first copy's dataOffset instead of writing their own. Only entries with the same payload
+        // alignment that are both stored or both compressible share a copy.
+        bool deduplicate {true};
+    };
+
+    struct VpkWriteStats
+    {
+        size_t   entries {0};
+        size_t   dedupedEntries {0}; // entries that reuse an earlier payload
+        uint64_t dedupedBytes {0};   // packed payload bytes not written thanks to deduplication
+        size_t   zstdEntries {0};    // written payloads per encoding (framed ones count as zstd)
+        size_t   lz4Entries {0};
+        size_t   storedEntries {0};
+    };
+
+    class VpkWriterState;
+
+    // Incremental VPK writer: open(), add() each entry, finish(). Entries are compressed a small window
+    // at a time (across options.threads workers) and appended in add() order, so memory stays bounded
+    // by that window instead of the whole package. The output matches writeVpk over the same items.
+    // A writer that is destroyed before finish() leaves an incomplete file behind.
+    class VpkWriter final
+    {
+    public:
+        VpkWriter();
+        ~VpkWriter();
+
+        VpkWriter(const VpkWriter&)            = delete;
+        VpkWriter& operator=(const VpkWriter&) = delete;
+
+        vbase::Result<void, AssetError> open(vbase::StringView outPath, const VpkWriteOptions& options = {});
+        vbase::Result<void, AssetError> add(VpkWriteItem item);
+
+        // Record `logicalPath` as removed (a payload-less kVpkEntryFlagTombstone entry).
+        vbase::Result<void, AssetError> addTombstone(vbase::StringView logicalPath);
+
+        // Flush the queued entries, write the index, registry and sections, and close the file.
+        vbase::Result<void, AssetError> finish();
+
+        size_t   entryCount() const;   // entries added so far
+        uint64_t bytesWritten() const; // file bytes written so far
+
+        // Counters of the entries appended so far; after finish(), of the whole package.
+        VpkWriteStats stats() const;
+
+    private:
+        std::unique_ptr<VpkWriterState> m_State;
+        VpkWriteStats                   m_FinishedStats;
     };
 
     // Write a VPK to disk (per-entry zstd).
+    vbase::Result<void, AssetError>
+    writeVpk(vbase::StringView outPath, const std::vector<VpkWriteItem>& items, const VpkWriteOptions& options);
+
     vbase::Result<void, AssetError>
     writeVpk(vbase::StringView outPath, const std::vector<VpkWriteItem>& items, int zstdLevel);
 
+    struct VpkPatchStats
+    {
+        size_t added {0};
+        size_t changed {0};
+        size_t removed {0}; // tombstones written
+        size_t unchanged {0};
+    };
+
+    // Write a patch package that turns `basePath` into `newPath` when mounted over it: every entry of
+    // the new package whose decoded bytes differ from the base (or that the base lacks), plus a
+    // tombstone for every base path the new package no longer has. Entries are compared by content,
+    // so a repack that only changes compression settings yields an empty patch.
+    vbase::Result<VpkPatchStats, AssetError> writeVpkPatch(vbase::StringView      outPath,
+                                                           vbase::StringView      basePath,
+                                                           vbase::StringView      newPath,
+                                                           const VpkWriteOptions& options = {});
+
+    struct VpkFileSystemOptions
+    {
+        // Map the pack once at openPackage() instead of opening a stream per read. Uncompressed
+        // entries are then served as files borrowing the mapping (no read, no copy). Ignored for
+        // multi-volume packs, whose payloads are read from their volumes.
+        bool memoryMap {false};
+
+        // Entries whose raw size is at least this many bytes are opened as streaming files that
+        // decode on read() instead of inflating the whole payload at open(). 0 disables streaming.
+        // eZstdFrames entries are always opened seekable and decode only the frames a read touches.
+        uint64_t streamingThreshold {16ull << 20};
+
+        // Byte budget of an LRU cache of decoded entries. A cache hit opens a file sharing the cached
+        // buffer, with no read and no decompression. Only entries decoded whole at open() (below
+        // streamingThreshold, not framed, not borrowed from an image) and no larger than the budget
+        // are cached. Buffers still held by open files outlive their eviction. 0 disables the cache.
+        uint64_t cacheBudget {0};
+
+        // Sets VpkReadOnly::verifyOnRead on the opened package. Streaming, framed and borrowed
+        // (image-backed, uncompressed) opens are not checked.
+        bool verifyOnRead {false};
+    };
+
+    struct VpkPrefetchResult
+    {
+        size_t                   entries {0}; // the root and its dependencies found in the package
+        uint64_t                 bytes {0};   // packed bytes hinted for readahead
+        std::shared_future<void> decoded; // set when entries are decoded into the cache in the background
+    };
+
+    struct VpkCacheStats
+    {
+        uint64_t hits {0};
+        uint64_t misses {0}; // cacheable opens that had to read + decode
+        uint64_t evictions {0};
+        uint64_t bytes {0}; // decoded bytes currently held
+        uint64_t entries {0};
+    };
+
+    class VpkEntryCache;
+    class VpkAccessTrace;
+    class VpkPrefetchWorker;
+
     // A filesystem view over a VPK file (on disk) or an in-memory VPK blob (embedded).
     class VpkFileSystem final : public vfilesystem::IFileSystem
     {
     public:
-        explicit VpkFileSystem(std::string vpkPath);
+        explicit VpkFileSystem(std::string vpkPath, VpkFileSystemOptions options = {});
 
         // Construct over an in-memory VPK image. The blob is copied and owned, so the
-        // source bytes need not outlive the filesystem. Use this for embedded packs.
-        explicit VpkFileSystem(std::vector<std::byte> blob);
+        // source bytes need not outlive the filesystem. Use this for embedded packs (memoryMap is
+        // ignored). Multi-volume packs fail to open this way with eNotSupported.
+        explicit VpkFileSystem(std::vector<std::byte> blob, VpkFileSystemOptions options = {});
 
         vbase::Result<void, AssetError> openPackage();
 
+        // exists/isFile/isDirectory/stat are answered from the index and directory table alone; no
+        // payload is read or decompressed.
         bool exists(vbase::StringView p) const override;
         bool isFile(vbase::StringView p) const override;
         bool isDirectory(vbase::StringView p) const override;
 
+        vbase::Result<VpkFileStat, AssetError> stat(vbase::StringView p) const;
+
+        // Immediate children of directory `p` (see listVpkDirectory). Names alias the package and
+        // stay valid for the lifetime of this filesystem.
+        vbase::Result<std::vector<VpkListEntry>, AssetError> listDirectory(vbase::StringView p) const;
+
         vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
         open(vbase::StringView p, vfilesystem::FileMode mode) override;
 
+        // As open(p, eRead), addressed by asset UUID through the package's UUID index; no path is
+        // built or hashed.
+        vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError> open(const vbase::UUID& uuid);
+
+        // Borrow an uncompressed entry's bytes without copying. Only available for memory-mapped or
+        // in-memory packs; the span stays valid for the lifetime of this filesystem.
+        vbase::Result<vbase::ConstByteSpan, AssetError> view(vbase::StringView p) const;
+
         const VpkReadOnly& getVpk() const { return m_Pkg; }
 
+        // Warm everything `root` will load: the asset and its dependencies up to `depth` hops (see
+        // collectVpkDependencies). Their payloads are hinted for readahead (madvise WILLNEED for mapped
+        // and embedded packs, posix_fadvise WILLNEED for streamed ones), which does not block. With an
+        // entry cache, the entries open() would serve from it are also decoded into it on the
+        // filesystem's prefetch thread, one request at a time; wait on `decoded` to know when that is
+        // done. Dropping the result does not wait. Destroying the filesystem joins the thread; requests
+        // it has not started by then are marked done without decoding.
+        VpkPrefetchResult prefetch(const vbase::UUID& root, uint32_t depth = UINT32_MAX);
+
+        // Counters of the decoded-entry cache (all zero when cacheBudget is 0). Thread-safe.
+        VpkCacheStats cacheStats() const;
+        void          clearCache();
+
+        // Record every successful open() to `tracePath`: one "<microseconds>\t<raw size>\t<path>"
+        // line per open, timed from beginTrace(). The recording feeds `vasset-cli pack
+        // --layout-trace`. A running trace is replaced. Opens may record from any thread, but
+        // beginTrace/endTrace must not race with open().
+        vbase::Result<void, AssetError> beginTrace(vbase::StringView tracePath);
+        void                            endTrace(); // flush and close; also done on destruction
+
+    private:
+        // VpkMultiFileSystem opens and views the entries its merged index resolved, without a second lookup.
+        friend class VpkMultiFileSystem;
+
+        // Whether open() serves `e` through the entry cache.
+        bool cachesEntry(const VpkEntry& e) const;
+
+        vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError> openEntry(const VpkEntry& e);
+        vbase::Result<vbase::ConstByteSpan, AssetError>                           viewEntry(const VpkEntry& e) const;
+
+        std::string          m_Path;
+        VpkFileSystemOptions m_Options;
+        VpkReadOnly          m_Pkg;
+        bool                 m_Ready {false};
+
+        // In-memory image (embedded blob or file mapping). Empty for stream-backed packs; m_Image
+        // aliases the storage kept alive by m_ImageOwner.
+        std::shared_ptr<const void> m_ImageOwner;
+        vbase::ConstByteSpan        m_Image;
+
+        std::shared_ptr<VpkEntryCache>     m_Cache;    // null unless cacheBudget > 0
+        std::shared_ptr<VpkAccessTrace>    m_Trace;    // null unless tracing
+        std::shared_ptr<VpkPrefetchWorker> m_Prefetch; // started by the first prefetch() that decodes
+    };
+
+    // Paths recorded by VpkFileSystem::beginTrace, in the order a pack should lay them out: by the
+    // earliest position at which any session first opened them (ties keep session order). eNotFound
+    // when a trace is missing, eInvalidFormat when it is not a trace.
+    vbase::Result<std::vector<std::string>, AssetError>
+    readVpkAccessTraces(const std::vector<std::string>& tracePaths);
+
+    // A priority stack of opened packages, typically a base package with patch packages mounted over
+    // it. Lookups walk from the most recently mounted layer down: the first layer holding the path
+    // serves it, and a tombstone hides the path in every layer below. isDirectory is true when any
+    // layer has the directory, even if tombstones above have removed all of its files.
+    class VpkOverlayFileSystem final : public vfilesystem::IFileSystem
+    {
+    public:
+        // Mount an opened package on top of the stack (it takes priority over every earlier mount).
+        void   mount(std::shared_ptr<VpkFileSystem> layer);
+        size_t layerCount() const { return m_Layers.size(); }
+
+        bool exists(vbase::StringView p) const override;
+        bool isFile(vbase::StringView p) const override;
+        bool isDirectory(vbase::StringView p) const override;
+
+        vbase::Result<VpkFileStat, AssetError> stat(vbase::StringView p) const;
+
+        // Children merged across layers, in listVpkDirectory order. Files hidden by a tombstone are
+        // dropped; on a name clash the upper layer's entry is reported.
+        vbase::Result<std::vector<VpkListEntry>, AssetError> listDirectory(vbase::StringView p) const;
+
+        vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
+        open(vbase::StringView p, vfilesystem::FileMode mode) override;
+
+        vbase::Result<vbase::ConstByteSpan, AssetError> view(vbase::StringView p) const;
+
     private:
-        std::string            m_Path;
-        std::vector<std::byte> m_Blob;   // populated when constructed from memory
-        bool                   m_Memory {false};
-        VpkReadOnly            m_Pkg;
-        bool                   m_Ready {false};
+        // The layer serving `p`, or nullptr when no layer has it or a tombstone hides it.
+        VpkFileSystem* resolve(vbase::StringView p) const;
+
+        std::vector<std::shared_ptr<VpkFileSystem>> m_Layers; // bottom first
+    };
+
+    struct VpkMultiIndex;
+
+    // Several opened packages (a base package plus DLC packs, say) behind one merged lookup index. A
+    // path is served by the mount with the highest priority holding it; equal priorities favour the
+    // later mount, and a tombstone in a mount hides the path from every mount below it. Each mount
+    // keeps a Bloom filter of its path hashes, consulted while merging, and the merged index keeps one
+    // over the visible paths, so a miss is usually answered by one filter probe. mount() rebuilds the
+    // index; a mounted package must not be reopened.
+    class VpkMultiFileSystem final : public vfilesystem::IFileSystem
+    {
+    public:
+        VpkMultiFileSystem();
+        ~VpkMultiFileSystem() override;
+
+        void   mount(std::shared_ptr<VpkFileSystem> pack, int priority = 0);
+        size_t mountCount() const;
+        size_t fileCount() const; // distinct visible paths
+
+        bool exists(vbase::StringView p) const override;
+        bool isFile(vbase::StringView p) const override;
+        bool isDirectory(vbase::StringView p) const override;
+
+        vbase::Result<VpkFileStat, AssetError> stat(vbase::StringView p) const;
+
+        // Children merged across mounts, in listVpkDirectory order. Only the mount serving a file
+        // reports it.
+        vbase::Result<std::vector<VpkListEntry>, AssetError> listDirectory(vbase::StringView p) const;
+
+        vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
+        open(vbase::StringView p, vfilesystem::FileMode mode) override;
+
+        vbase::Result<vbase::ConstByteSpan, AssetError> view(vbase::StringView p) const;
+
+    private:
+        // The mount serving `p` and its entry for it, or {nullptr, nullptr}.
+        std::pair<VpkFileSystem*, const VpkEntry*> resolve(vbase::StringView p) const;
+
+        std::unique_ptr<VpkMultiIndex> m_Index;
     };
 
 } // namespace vasset
@@ -8,7 +8,11 @@
 #include <vasset/vtexture.hpp>
 
 #include <algorithm>
+#include <bit>
 #include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -309,17 +313,18 @@ namespace
         std::unordered_map<std::string, VAssetType>  registryPathToType;
         std::unordered_map<std::string, std::string> registryPathToDataPath;
 
+        std::string scratch;
         for (size_t i = 0; i < pkg.entries.size(); ++i)
         {
-            const auto& entry = pkg.entries[i];
-            if (entry.pathOffset + entry.pathSize > pkg.stringTable.size())
+            const auto&            entry = pkg.entries[i];
+            const std::string_view path  = vpkPathOf(pkg, entry, scratch);
+            if (path.size() != entry.pathSize)
             {
                 report.errors.push_back("Index entry #" + std::to_string(i) + " has invalid path offset/size");
                 continue;
             }
 
-            std::string logicalPath(pkg.stringTable.data() + entry.pathOffset, entry.pathSize);
-            logicalPath = normalizePackFilterPath(std::move(logicalPath));
+            std::string logicalPath = normalizePackFilterPath(std::string(path));
             if (logicalPath.empty())
             {
                 report.errors.push_back("Index entry #" + std::to_string(i) + " has empty logical path");
@@ -350,15 +355,15 @@ namespace
 
         for (size_t i = 0; i < pkg.registry.size(); ++i)
         {
-            const auto& registryEntry = pkg.registry[i];
-            if (registryEntry.pathOffset + registryEntry.pathSize > pkg.stringTable.size())
+            const auto&            registryEntry = pkg.registry[i];
+            const std::string_view path          = vpkPathOf(pkg, registryEntry, scratch);
+            if (path.size() != registryEntry.pathSize)
             {
                 report.errors.push_back("Registry entry #" + std::to_string(i) + " has invalid path offset/size");
                 continue;
             }
 
-            std::string logicalPath(pkg.stringTable.data() + registryEntry.pathOffset, registryEntry.pathSize);
-            logicalPath = normalizePackFilterPath(std::move(logicalPath));
+            std::string logicalPath = normalizePackFilterPath(std::string(path));
             if (logicalPath.empty())
             {
                 report.errors.push_back("Registry entry #" + std::to_string(i) + " has empty logical path");
@@ -569,9 +574,15 @@ static bool parsePackExtraArgs(int                       argc,
                                char**                    argv,
                                int                       start,
                                int&                      zstdLevel,
+                               uint32_t&                 threads,
+                               uint32_t&                 alignment,
+                               VpkCodec&                 codec,
+                               bool&                     frontCodedPaths,
+                               uint64_t&                 volumeSize,
                                std::vector<std::string>& includePaths,
                                std::vector<std::string>& rootPaths,
-                               std::vector<VpkExtraDir>& extraDirs)
+                               std::vector<VpkExtraDir>& extraDirs,
+                               std::vector<std::string>& layoutTraces)
 {
     for (int i = start; i < argc; ++i)
     {
@@ -582,6 +593,70 @@ static bool parsePackExtraArgs(int                       argc,
             std::cout << "Using zstd compression level: " << zstdLevel << std::endl;
             ++i;
         }
+        else if (a == "--threads" && i + 1 < argc)
+        {
+            threads = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+            ++i;
+        }
+        else if (a == "--align" && i + 1 < argc)
+        {
+            alignment = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+            if (!std::has_single_bit(alignment))
+            {
+                std::cerr << "Invalid --align (expected a power of two): " << argv[i + 1] << std::endl;
+                return false;
+            }
+            ++i;
+        }
+        else if (a == "--codec" && i + 1 < argc)
+        {
+            const std::string name = argv[i + 1];
+            if (name == "zstd")
+                codec = VpkCodec::eZstd;
+            else if (name == "lz4")
+                codec = VpkCodec::eLz4;
+            else if (name == "adaptive")
+                codec = VpkCodec::eAdaptive;
+            else
+            {
+                std::cerr << "Invalid --codec (expected zstd, lz4 or adaptive): " << name << std::endl;
+                return false;
+            }
+            ++i;
+        }
+        else if (a == "--front-coded-paths")
+        {
+            frontCodedPaths = true;
+        }
+        else if (a == "--volume-size" && i + 1 < argc)
+        {
+            // Bytes, with an optional K/M/G suffix (binary units).
+            errno = 0;
+            char*          end   = nullptr;
+            const uint64_t value = std::strtoull(argv[i + 1], &end, 10);
+            uint32_t       shift = 0;
+            if (*end == 'K' || *end == 'k')
+                shift = 10;
+            else if (*end == 'M' || *end == 'm')
+                shift = 20;
+            else if (*end == 'G' || *end == 'g')
+                shift = 30;
+            // Reject values that overflow 64 bits, before or after the suffix is applied.
+            if (value == 0 || end == argv[i + 1] || (shift > 0 ? end[1] != '\0' : *end != '\0') ||
+                errno == ERANGE || value > (UINT64_MAX >> shift))
+            {
+                std::cerr << "Invalid --volume-size (expected bytes, optionally suffixed K, M or G): " << argv[i + 1]
+                          << std::endl;
+                return false;
+            }
+            volumeSize = value << shift;
+            ++i;
+        }
+        else if (a == "--layout-trace" && i + 1 < argc)
+        {
+            layoutTraces.push_back(argv[i + 1]);
+            ++i;
+        }
         else if (a == "--include" && i + 1 < argc)
         {
             includePaths.push_back(normalizePackFilterPath(argv[i + 1]));
@@ -642,6 +717,12 @@ static int cmd_pack(int argc, char** argv)
                      "  - out.vpk: output package\n"
                      "Optional:\n"
                      "  --zstd <level>\n"
+                     "  --threads <count>   compression workers (default: all cores)\n"
+                     "  --align <bytes>     start each payload on this power-of-two boundary (e.g. 4096)\n"
+                     "  --codec <zstd|lz4|adaptive>   adaptive picks per entry by estimated load time\n"
+                     "  --front-coded-paths   store paths front-coded (less resident index memory)\n"
+                     "  --volume-size <bytes[K|M|G]>   split payloads into <out.vpk>.000, .001, ... volumes\n"
+                     "  --layout-trace <file>   lay out traced assets in first-access order (repeatable)\n"
                      "  --include <logical-path-prefix>\n"
                      "  --root <scene-or-asset-root>\n"
                      "  --extra-dir <dir>=<logical/prefix>   pack a directory outside the asset root\n"
@@ -661,11 +742,29 @@ static int cmd_pack(int argc, char** argv)
     std::string assetRoot = assetRootResolved.generic_string();
     std::string outVpk    = argv[2];
 
-    int                      zstdLevel = 6;
+    int                      zstdLevel  = 6;
+    uint32_t                 threads    = 0;
+    uint32_t                 alignment  = 1;
+    VpkCodec                 codec      = VpkCodec::eZstd;
+    bool                     frontCoded = false;
+    uint64_t                 volumeSize = 0;
     std::vector<std::string> includePaths;
     std::vector<std::string> rootPaths;
     std::vector<VpkExtraDir> extraDirs;
-    if (!parsePackExtraArgs(argc, argv, 3, zstdLevel, includePaths, rootPaths, extraDirs))
+    std::vector<std::string> layoutTraces;
+    if (!parsePackExtraArgs(argc,
+                            argv,
+                            3,
+                            zstdLevel,
+                            threads,
+                            alignment,
+                            codec,
+                            frontCoded,
+                            volumeSize,
+                            includePaths,
+                            rootPaths,
+                            extraDirs,
+                            layoutTraces))
         return 1;
 
     if (!includePaths.empty())
@@ -701,10 +800,16 @@ static int cmd_pack(int argc, char** argv)
     if (fs::exists(registryPath) && registry.load(registryPath))
     {
         VpkPackOptions options;
-        options.zstdLevel   = zstdLevel;
-        options.includePaths = includePaths;
-        options.rootPaths    = rootPaths;
-        options.extraDirs    = extraDirs;
+        options.zstdLevel        = zstdLevel;
+        options.threads          = threads;
+        options.payloadAlignment = alignment;
+        options.codec            = codec;
+        options.frontCodedPaths  = frontCoded;
+        options.volumeSize       = volumeSize;
+        options.includePaths     = includePaths;
+        options.rootPaths        = rootPaths;
+        options.extraDirs        = extraDirs;
+        options.layoutTraces     = layoutTraces;
 
         auto packResult = packAssetFolderToVpk(assetRoot, outVpk, options);
         if (!packResult)
@@ -722,6 +827,11 @@ static int cmd_pack(int argc, char** argv)
         std::cerr << "--extra-dir requires an imported asset registry: " << registryPath << std::endl;
         return 1;
     }
+    if (!layoutTraces.empty())
+    {
+        std::cerr << "--layout-trace requires an imported asset registry: " << registryPath << std::endl;
+        return 1;
+    }
 
     // Pack rule (pure pipeline):
     // - Scan for *.vimport under assetRoot
@@ -828,7 +938,15 @@ static int cmd_pack(int argc, char** argv)
         return 1;
     }
 
-    auto wr = writeVpk(outVpk, items, zstdLevel);
+    VpkWriteOptions writeOptions {};
+    writeOptions.zstdLevel        = zstdLevel;
+    writeOptions.threads          = threads;
+    writeOptions.payloadAlignment = alignment;
+    writeOptions.codec            = codec;
+    writeOptions.frontCodedPaths  = frontCoded;
+    writeOptions.volumeSize       = volumeSize;
+
+    auto wr = writeVpk(outVpk, items, writeOptions);
     if (!wr)
     {
         std::cerr << "Failed to write vpk: " << outVpk << std::endl;
@@ -848,6 +966,8 @@ static int cmd_validate_vpk(int argc, char** argv)
                      "Optional:\n"
                      "  --asset-root <asset-root>\n"
                      "  --registry <path/to/asset_registry.tsv>\n"
+                     "  --deep              decode every entry and check it against its stored checksum\n"
+                     "  --threads <N>       workers for --deep (default: hardware concurrency)\n"
                   << std::endl;
         return 1;
     }
@@ -855,6 +975,8 @@ static int cmd_validate_vpk(int argc, char** argv)
     std::filesystem::path vpkPath(argv[1]);
     std::filesystem::path assetRoot;
     std::filesystem::path registryPath;
+    bool                  deep    = false;
+    uint32_t              threads = 0;
 
     for (int i = 2; i < argc; ++i)
     {
@@ -877,6 +999,19 @@ static int cmd_validate_vpk(int argc, char** argv)
             }
             registryPath = argv[++i];
         }
+        else if (arg == "--deep")
+        {
+            deep = true;
+        }
+        else if (arg == "--threads")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for --threads" << std::endl;
+                return 1;
+            }
+            threads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
         else
         {
             std::cerr << "Unknown option: " << arg << std::endl;
@@ -916,11 +1051,28 @@ static int cmd_validate_vpk(int argc, char** argv)
 
     auto report = validateVpkPackage(vpkPath, assetRoot, registryPath);
 
+    // A pack that fails to open is already reported above.
+    VpkVerifyReport deepReport;
+    if (deep)
+    {
+        if (auto vpk = openVpk(vpkPath.generic_string()))
+        {
+            deepReport = verifyVpk(vpk.value(), vpkPath.generic_string(), threads);
+            for (const auto& path : deepReport.corrupt)
+                report.errors.push_back("Corrupt entry: " + path);
+        }
+    }
+
     std::cout << "\nValidation summary:" << std::endl;
     std::cout << "  index entries checked: " << report.checkedIndexEntries << std::endl;
     std::cout << "  registry entries checked: " << report.checkedRegistryEntries << std::endl;
     std::cout << "  tsv entries checked: " << report.checkedTsvEntries << std::endl;
     std::cout << "  filesystem entries checked: " << report.checkedFilesystemEntries << std::endl;
+    if (deep)
+    {
+        std::cout << "  payloads verified: " << deepReport.checked << std::endl;
+        std::cout << "  payloads without checksum: " << deepReport.unverified << std::endl;
+    }
 
     printIssueList("Warnings", report.warnings, 20);
     printIssueList("Errors", report.errors, 40);
@@ -935,14 +1087,57 @@ static int cmd_validate_vpk(int argc, char** argv)
     return 0;
 }
 
+// Diff <new.vpk> against <base.vpk> and write only the changed entries (plus tombstones for removed
+// paths) to <out.vpk>, to be mounted above the base with VpkOverlayFileSystem.
+static int cmd_patch(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: vasset-cli patch <base.vpk> <new.vpk> <out.vpk> [--zstd N] [--threads N]" << std::endl;
+        return 1;
+    }
+
+    VpkWriteOptions options {};
+    for (int i = 4; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if ((a == "--zstd" || a == "--threads") && i + 1 < argc)
+        {
+            const auto v = std::strtoul(argv[++i], nullptr, 10);
+            if (a == "--zstd")
+                options.zstdLevel = static_cast<int>(v);
+            else
+                options.threads = static_cast<uint32_t>(v);
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete option: " << a << std::endl;
+            return 1;
+        }
+    }
+
+    auto stats = writeVpkPatch(argv[3], argv[1], argv[2], options);
+    if (!stats)
+    {
+        std::cerr << "Failed to write patch VPK: " << argv[3] << std::endl;
+        return 2;
+    }
+
+    const auto& s = stats.value();
+    std::cout << "Patch VPK: " << argv[3] << " (" << s.added << " added, " << s.changed << " changed, " << s.removed
+              << " removed, " << s.unchanged << " unchanged)" << std::endl;
+    return 0;
+}
+
 // Import the asset folder, then pack it into <out.vpk> -- import + pack in a single process (one
 // folder scan's worth of work per phase, instead of import running twice across separate tools).
 static int cmd_cook(int argc, char** argv, const VAssetImporter::ImportOptions& importOptions = {})
 {
     if (argc < 3)
     {
-        std::cout << "Usage: vasset-cli cook <asset-root> <out.vpk> [--reimport] [--zstd N] "
-                     "[--include logical/path] [--root res://scene-or-asset]\n"
+        std::cout << "Usage: vasset-cli cook <asset-root> <out.vpk> [--reimport] [--zstd N] [--threads N] [--align N] "
+                     "[--codec zstd|lz4|adaptive] [--front-coded-paths] [--volume-size N] [--include logical/path] "
+                     "[--root res://scene-or-asset]\n"
                   << "  Imports the asset folder, then packs it into <out.vpk> (import + pack)." << std::endl;
         return 1;
     }
@@ -1004,9 +1199,10 @@ int run_vasset_cli(int argc, char** argv, const VAssetImporter::ImportOptions& i
                 R"(Usage:
 
     vasset-cli import <asset-root> [--reimport]
-    vasset-cli pack <asset-root> <out.vpk> [--zstd N] [--include logical/path] [--root res://scene-or-asset] [--extra-dir dir=logical/prefix] [--extra-exclude logical/prefix=glob]
-    vasset-cli cook <asset-root> <out.vpk> [--reimport] [--zstd N] [--include logical/path] [--root res://scene-or-asset] [--extra-dir dir=logical/prefix] [--extra-exclude logical/prefix=glob]
-    vasset-cli validate-vpk <path/to/resources.vpk> [--asset-root <asset-root>] [--registry <asset_registry.tsv>]
+    vasset-cli pack <asset-root> <out.vpk> [--zstd N] [--threads N] [--align N] [--codec zstd|lz4|adaptive] [--front-coded-paths] [--volume-size N] [--layout-trace file] [--include logical/path] [--root res://scene-or-asset] [--extra-dir dir=logical/prefix] [--extra-exclude logical/prefix=glob]
+    vasset-cli cook <asset-root> <out.vpk> [--reimport] [--zstd N] [--threads N] [--align N] [--codec zstd|lz4|adaptive] [--front-coded-paths] [--volume-size N] [--layout-trace file] [--include logical/path] [--root res://scene-or-asset] [--extra-dir dir=logical/prefix] [--extra-exclude logical/prefix=glob]
+    vasset-cli validate-vpk <path/to/resources.vpk> [--asset-root <asset-root>] [--registry <asset_registry.tsv>] [--deep] [--threads N]
+    vasset-cli patch <base.vpk> <new.vpk> <out.vpk> [--zstd N] [--threads N]
 )" << std::endl;
             return 1;
         }
@@ -1020,6 +1216,8 @@ int run_vasset_cli(int argc, char** argv, const VAssetImporter::ImportOptions& i
             return cmd_cook(argc - 1, argv + 1, importOptions);
         if (cmd == "validate-vpk")
             return cmd_validate_vpk(argc - 1, argv + 1);
+        if (cmd == "patch")
+            return cmd_patch(argc - 1, argv + 1);
 
         // Backward compatible: treat as legacy import usage (no explicit command)
         return cmd_import(argc, argv, importOptions);
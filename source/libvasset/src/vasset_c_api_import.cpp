@@ -56,6 +56,36 @@ extern "C"
         if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options))
             h->options.zstdLevel = level;
     }
+    void vasset_pack_options_set_threads(VAssetPackOptionsHandle options, uint32_t threads)
+    {
+        if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options))
+            h->options.threads = threads;
+    }
+    void vasset_pack_options_set_alignment(VAssetPackOptionsHandle options, uint32_t alignment)
+    {
+        if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options))
+            h->options.payloadAlignment = alignment;
+    }
+    void vasset_pack_options_set_codec(VAssetPackOptionsHandle options, int32_t codec)
+    {
+        if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options); h && codec >= 0 && codec <= 2)
+            h->options.codec = static_cast<vasset::VpkCodec>(codec);
+    }
+    void vasset_pack_options_set_front_coded_paths(VAssetPackOptionsHandle options, int32_t enabled)
+    {
+        if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options))
+            h->options.frontCodedPaths = enabled != 0;
+    }
+    void vasset_pack_options_set_volume_size(VAssetPackOptionsHandle options, uint64_t bytes)
+    {
+        if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options))
+            h->options.volumeSize = bytes;
+    }
+    void vasset_pack_options_add_layout_trace(VAssetPackOptionsHandle options, const char* tracePath)
+    {
+        if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options); h && tracePath)
+            h->options.layoutTraces.emplace_back(tracePath);
+    }
     void vasset_pack_options_add_include_path(VAssetPackOptionsHandle options, const char* path)
     {
         if (auto* h = reinterpret_cast<VAssetPackOptions_t*>(options); h && path)
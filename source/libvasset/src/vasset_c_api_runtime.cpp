@@ -27,6 +27,12 @@ struct VAssetVpk_t
     std::vector<std::byte> blob;  // owned image (memory-backed)
 };
 
+struct VAssetVpkListing_t
+{
+    std::vector<std::string> names;
+    std::vector<bool>        isDirectory;
+};
+
 struct VAssetResolver_t
 {
     vasset::VUUIDResolver resolver;
@@ -181,12 +187,151 @@ extern "C"
         return fillBlob(outBlob, read.value());
     }
 
+    int32_t vasset_vpk_read_uuid(VAssetVpkHandle vpk, const char* uuid, VAssetBlob* outBlob)
+    {
+        auto*       h = reinterpret_cast<VAssetVpk_t*>(vpk);
+        vbase::UUID id {};
+        if (!h || !parseUuid(uuid, id))
+            return fail(VASSET_ERR_INVALID_ARG, "null vpk handle or invalid uuid");
+
+        auto read = h->memory ? vasset::readVpkFileFromMemoryByUuid(
+                                    h->vpk, vbase::ConstByteSpan {h->blob.data(), h->blob.size()}, id)
+                              : vasset::readVpkFileByUuid(h->vpk, h->path, id);
+        if (!read)
+            return failAsset(read.error(), "readVpkFileByUuid failed");
+        return fillBlob(outBlob, read.value());
+    }
+
+    int32_t vasset_vpk_read_batch(VAssetVpkHandle    vpk,
+                                  const char* const* logicalPaths,
+                                  size_t             count,
+                                  VAssetBlob*        outBlobs,
+                                  int32_t*           outStatus)
+    {
+        auto* h = reinterpret_cast<VAssetVpk_t*>(vpk);
+        if (!h || (count > 0 && (!logicalPaths || !outBlobs)))
+            return fail(VASSET_ERR_INVALID_ARG, "null vpk handle, paths or out blobs");
+
+        std::vector<vbase::StringView> paths(count);
+        for (size_t i = 0; i < count; ++i)
+            paths[i] = logicalPaths[i] ? vbase::StringView {logicalPaths[i]} : vbase::StringView {};
+
+        auto reads = h->memory ? vasset::readVpkFilesFromMemory(
+                                     h->vpk, vbase::ConstByteSpan {h->blob.data(), h->blob.size()}, paths)
+                               : vasset::readVpkFiles(h->vpk, h->path, paths);
+
+        int32_t result = VASSET_OK;
+        for (size_t i = 0; i < count; ++i)
+        {
+            int32_t status = VASSET_OK;
+            if (reads[i].error != vasset::AssetError::eOk)
+                status = failAsset(reads[i].error, "readVpkFiles failed");
+            else
+                status = fillBlob(&outBlobs[i], reads[i].bytes);
+
+            if (status != VASSET_OK)
+            {
+                outBlobs[i] = VAssetBlob {nullptr, 0};
+                if (result == VASSET_OK)
+                    result = status;
+            }
+            if (outStatus)
+                outStatus[i] = status;
+        }
+        return result;
+    }
+
+    int32_t vasset_vpk_stat(VAssetVpkHandle vpk,
+                            const char*     logicalPath,
+                            uint64_t*       outRawSize,
+                            uint64_t*       outPackedSize,
+                            int32_t*        outCompression)
+    {
+        auto* h = reinterpret_cast<VAssetVpk_t*>(vpk);
+        if (!h || !logicalPath)
+            return fail(VASSET_ERR_INVALID_ARG, "null vpk handle or path");
+
+        auto st = vasset::statVpkFile(h->vpk, logicalPath);
+        if (!st)
+            return failAsset(st.error(), "statVpkFile failed");
+        if (outRawSize)
+            *outRawSize = st.value().rawSize;
+        if (outPackedSize)
+            *outPackedSize = st.value().packedSize;
+        if (outCompression)
+            *outCompression = static_cast<int32_t>(st.value().compression);
+        return VASSET_OK;
+    }
+
     uint32_t vasset_vpk_file_count(VAssetVpkHandle vpk)
     {
         auto* h = reinterpret_cast<VAssetVpk_t*>(vpk);
         return h ? static_cast<uint32_t>(h->vpk.entries.size()) : 0;
     }
 
+    int32_t vasset_vpk_is_directory(VAssetVpkHandle vpk, const char* dirPath)
+    {
+        auto* h = reinterpret_cast<VAssetVpk_t*>(vpk);
+        if (!h || !dirPath)
+            return 0;
+        return vasset::isVpkDirectory(h->vpk, dirPath) ? 1 : 0;
+    }
+
+    VAssetVpkListingHandle vasset_vpk_list_directory(VAssetVpkHandle vpk, const char* dirPath)
+    {
+        auto* h = reinterpret_cast<VAssetVpk_t*>(vpk);
+        if (!h || !dirPath)
+        {
+            fail(VASSET_ERR_INVALID_ARG, "null vpk handle or path");
+            return nullptr;
+        }
+
+        auto listed = vasset::listVpkDirectory(h->vpk, dirPath);
+        if (!listed)
+        {
+            failAsset(listed.error(), "listVpkDirectory failed");
+            return nullptr;
+        }
+
+        auto* listing = new VAssetVpkListing_t();
+        listing->names.reserve(listed.value().size());
+        listing->isDirectory.reserve(listed.value().size());
+        for (const auto& child : listed.value())
+        {
+            listing->names.emplace_back(child.name);
+            listing->isDirectory.push_back(child.isDirectory);
+        }
+        return reinterpret_cast<VAssetVpkListingHandle>(listing);
+    }
+
+    void vasset_vpk_listing_destroy(VAssetVpkListingHandle listing)
+    {
+        delete reinterpret_cast<VAssetVpkListing_t*>(listing);
+    }
+
+    uint32_t vasset_vpk_listing_count(VAssetVpkListingHandle listing)
+    {
+        auto* h = reinterpret_cast<VAssetVpkListing_t*>(listing);
+        return h ? static_cast<uint32_t>(h->names.size()) : 0;
+    }
+
+    const char* vasset_vpk_listing_name_at(VAssetVpkListingHandle listing, uint32_t index)
+    {
+        static thread_local std::string buf;
+        auto* h = reinterpret_cast<VAssetVpkListing_t*>(listing);
+        if (!h || index >= h->names.size())
+            return hold(buf, "");
+        return hold(buf, h->names[index]);
+    }
+
+    int32_t vasset_vpk_listing_is_directory_at(VAssetVpkListingHandle listing, uint32_t index)
+    {
+        auto* h = reinterpret_cast<VAssetVpkListing_t*>(listing);
+        if (!h || index >= h->names.size())
+            return 0;
+        return h->isDirectory[index] ? 1 : 0;
+    }
+
     uint32_t vasset_vpk_asset_count(VAssetVpkHandle vpk)
     {
         auto* h = reinterpret_cast<VAssetVpk_t*>(vpk);
@@ -208,10 +353,8 @@ extern "C"
         auto* h = reinterpret_cast<VAssetVpk_t*>(vpk);
         if (!h || index >= h->vpk.registry.size())
             return hold(buf, "");
-        const auto& e = h->vpk.registry[index];
-        if (static_cast<size_t>(e.pathOffset) + e.pathSize > h->vpk.stringTable.size())
-            return hold(buf, "");
-        return hold(buf, std::string(h->vpk.stringTable.data() + e.pathOffset, e.pathSize));
+        std::string scratch;
+        return hold(buf, std::string(vasset::vpkPathOf(h->vpk, h->vpk.registry[index], scratch)));
     }
 
     int32_t vasset_vpk_asset_type_at(VAssetVpkHandle vpk, uint32_t index)
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -265,6 +266,113 @@ namespace vasset
             }
             return true;
         }
+
+        // One file to pack. Payloads are only read while the package is written, one at a time.
+        struct PackSource
+        {
+            std::string           logicalPath;
+            vbase::UUID           uuid {};
+            VAssetType            type {VAssetType::eUnknown};
+            std::filesystem::path filePath;
+            const char*           kind {"raw file"}; // for the "Missing ..." diagnostic
+            bool                  validateTexture {false};
+
+            std::vector<vbase::UUID> dependencies; // packed assets this one loads
+        };
+
+        // Lay the sources out in a depth-first preorder of the dependency graph, so each asset is
+        // followed by the meshes, materials and textures it pulls in and loading it reads the package
+        // mostly front to back. Walks start at the pack roots, then at every asset nothing else in
+        // the pack depends on (in path order); cycle-only leftovers come last. Edges to assets
+        // outside the pack are ignored. The result does not depend on registry iteration order.
+        void orderSourcesByDependencies(const VAssetRegistry&    registry,
+                                        const VpkPackOptions&    options,
+                                        std::vector<PackSource>& sources)
+        {
+            std::sort(sources.begin(), sources.end(), [](const PackSource& a, const PackSource& b) {
+                return a.logicalPath < b.logicalPath;
+            });
+
+            std::unordered_map<std::string, size_t> byUuid;
+            std::unordered_map<std::string, size_t> byPath;
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                byUuid.emplace(vbase::to_string(sources[i].uuid), i);
+                byPath.emplace(normalizePackRootPath(sources[i].logicalPath), i);
+                const auto entry = registry.lookup(sources[i].uuid);
+                if (!entry.importedPath.empty())
+                    byPath.emplace(normalizePackRootPath(entry.importedPath), i);
+            }
+
+            auto find = [&](const std::unordered_map<std::string, size_t>& map, const std::string& key) {
+                const auto it = map.find(key);
+                return it != map.end() ? std::optional<size_t>(it->second) : std::nullopt;
+            };
+
+            std::vector<std::vector<size_t>> edges(sources.size());
+            std::vector<bool>                referenced(sources.size(), false);
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                for (const auto& dep : registry.dependencies(sources[i].uuid))
+                {
+                    const auto target = dep.targetUuid.valid() ? find(byUuid, vbase::to_string(dep.targetUuid))
+                                                               : find(byPath, normalizePackRootPath(dep.targetPath));
+                    if (target && *target != i)
+                    {
+                        edges[i].push_back(*target);
+                        referenced[*target] = true;
+                    }
+                }
+            }
+
+            // The same edges become the package's dependency graph (VpkWriteItem::dependencies).
+            for (size_t i = 0; i < sources.size(); ++i)
+                for (const size_t target : edges[i])
+                    sources[i].dependencies.push_back(sources[target].uuid);
+
+            std::vector<size_t> order;
+            std::vector<bool>   visited(sources.size(), false);
+            std::vector<size_t> stack;
+            auto                walk = [&](size_t root) {
+                stack.push_back(root);
+                while (!stack.empty())
+                {
+                    const size_t node = stack.back();
+                    stack.pop_back();
+                    if (visited[node])
+                        continue;
+                    visited[node] = true;
+                    order.push_back(node);
+                    // Reversed, so the first listed dependency is laid out first.
+                    for (auto it = edges[node].rbegin(); it != edges[node].rend(); ++it)
+                        if (!visited[*it])
+                            stack.push_back(*it);
+                }
+            };
+
+            for (const auto& root : options.rootPaths)
+            {
+                vbase::UUID uuid {};
+                auto        node = std::optional<size_t> {};
+                if (vbase::try_parse_uuid(root.c_str(), uuid))
+                    node = find(byUuid, vbase::to_string(uuid));
+                if (!node)
+                    node = find(byPath, normalizePackRootPath(root));
+                if (node)
+                    walk(*node);
+            }
+            for (size_t i = 0; i < sources.size(); ++i)
+                if (!referenced[i])
+                    walk(i);
+            for (size_t i = 0; i < sources.size(); ++i)
+                walk(i);
+
+            std::vector<PackSource> ordered;
+            ordered.reserve(sources.size());
+            for (size_t node : order)
+                ordered.push_back(std::move(sources[node]));
+            sources = std::move(ordered);
+        }
     } // namespace
 
     bool matchPathGlob(std::string_view relPath, std::string_view glob)
@@ -378,7 +486,7 @@ namespace vasset
 
         const auto reachable = buildPackReachableSet(registry, options);
 
-        std::vector<VpkWriteItem>       items;
+        std::vector<PackSource>         sources;
         std::unordered_set<std::string> packedLogicalPaths;
         for (const auto& [uuidStr, entry] : registry.getRegistry())
         {
@@ -390,29 +498,24 @@ namespace vasset
             }
 
             const fs::path filePath = assetRootPath / packDataPathForEntry(entry, assetRootPath);
-            std::vector<std::byte> data = readBinaryFile(filePath);
-            if (data.empty() && !fs::exists(filePath))
+            if (!fs::exists(filePath))
             {
                 std::cerr << "Missing pack file: " << filePath.generic_string() << " (" << uuidStr << ")"
                           << std::endl;
                 continue;
             }
-            if (entry.type == VAssetType::eTexture &&
-                !validateTexturePayloadForPack(filePath.generic_string(), logicalPath, data))
-            {
-                return vbase::Result<size_t, AssetError>::err(AssetError::eInvalidFormat);
-            }
 
-            VpkWriteItem item;
-            item.logicalPath = logicalPath;
-            if (!vbase::try_parse_uuid(uuidStr.c_str(), item.uuid))
-                item.uuid = vbase::uuid_from_string_key(logicalPath);
-            item.type          = entry.type;
-            item.bytes         = std::move(data);
-            item.allowCompress = true;
+            PackSource source;
+            source.logicalPath = logicalPath;
+            if (!vbase::try_parse_uuid(uuidStr.c_str(), source.uuid))
+                source.uuid = vbase::uuid_from_string_key(logicalPath);
+            source.type            = entry.type;
+            source.filePath        = filePath;
+            source.kind            = "pack file";
+            source.validateTexture = entry.type == VAssetType::eTexture;
 
             packedLogicalPaths.insert(logicalPath);
-            items.push_back(std::move(item));
+            sources.push_back(std::move(source));
         }
 
         for (const auto& entry : fs::recursive_directory_iterator(assetRootPath))
@@ -433,22 +536,14 @@ namespace vasset
                 continue;
             }
 
-            std::vector<std::byte> data = readBinaryFile(p);
-            if (data.empty() && !fs::exists(p))
-            {
-                std::cerr << "Missing raw file: " << p.generic_string() << std::endl;
-                continue;
-            }
-
-            VpkWriteItem item;
-            item.logicalPath   = relPath;
-            item.uuid          = vbase::uuid_from_string_key(relPath);
-            item.type          = inferRuntimeRawAssetType(relPath);
-            item.bytes         = std::move(data);
-            item.allowCompress = true;
+            PackSource source;
+            source.logicalPath = relPath;
+            source.uuid        = vbase::uuid_from_string_key(relPath);
+            source.type        = inferRuntimeRawAssetType(relPath);
+            source.filePath    = p;
 
             packedLogicalPaths.insert(relPath);
-            items.push_back(std::move(item));
+            sources.push_back(std::move(source));
         }
 
         // Extra directories (content outside the asset root, e.g. managed plugins): pack every
@@ -485,35 +580,110 @@ namespace vasset
                 if (packedLogicalPaths.contains(logicalPath))
                     continue;
 
-                std::vector<std::byte> data = readBinaryFile(p);
-                if (data.empty() && !fs::exists(p))
-                {
-                    std::cerr << "Missing extra pack file: " << p.generic_string() << std::endl;
-                    continue;
-                }
-
-                VpkWriteItem item;
-                item.logicalPath   = logicalPath;
-                item.uuid          = vbase::uuid_from_string_key(logicalPath);
-                item.type          = inferRuntimeRawAssetType(logicalPath);
-                item.bytes         = std::move(data);
-                item.allowCompress = true;
+                PackSource source;
+                source.logicalPath = logicalPath;
+                source.uuid        = vbase::uuid_from_string_key(logicalPath);
+                source.type        = inferRuntimeRawAssetType(logicalPath);
+                source.filePath    = p;
+                source.kind        = "extra pack file";
 
                 packedLogicalPaths.insert(logicalPath);
-                items.push_back(std::move(item));
+                sources.push_back(std::move(source));
             }
         }
 
-        if (items.empty())
+        if (sources.empty())
         {
             std::cerr << "No packable assets found under: " << assetRootString << std::endl;
             return vbase::Result<size_t, AssetError>::err(AssetError::eNotFound);
         }
 
-        auto writeResult = writeVpk(outVpk, items, options.zstdLevel);
+        orderSourcesByDependencies(registry, options, sources);
+        if (!options.layoutTraces.empty())
+        {
+            auto traced = readVpkAccessTraces(options.layoutTraces);
+            if (!traced)
+            {
+                std::cerr << "Failed to read layout trace(s)" << std::endl;
+                return vbase::Result<size_t, AssetError>::err(traced.error());
+            }
+
+            std::unordered_map<std::string_view, size_t> rank;
+            for (const auto& path : traced.value())
+                rank.emplace(path, rank.size());
+            std::stable_sort(sources.begin(), sources.end(), [&](const PackSource& a, const PackSource& b) {
+                const auto ra = rank.find(a.logicalPath);
+                const auto rb = rank.find(b.logicalPath);
+                return (ra != rank.end() ? ra->second : SIZE_MAX) < (rb != rank.end() ? rb->second : SIZE_MAX);
+            });
+        }
+
+        VpkWriteOptions writeOptions {};
+        writeOptions.zstdLevel        = options.zstdLevel;
+        writeOptions.threads          = options.threads;
+        writeOptions.payloadAlignment = options.payloadAlignment;
+        writeOptions.codec            = options.codec;
+        writeOptions.frontCodedPaths  = options.frontCodedPaths;
+        writeOptions.volumeSize       = options.volumeSize;
+
+        // Stream the payloads through the writer: each file is read right before it is queued, so peak
+        // memory is the writer's window rather than the whole project.
+        VpkWriteStats writeStats;
+        size_t        packedCount = 0;
+        auto          writeResult = [&]() -> vbase::Result<void, AssetError> {
+            VpkWriter writer;
+            if (auto r = writer.open(outVpk, writeOptions); !r)
+                return r;
+
+            for (auto& source : sources)
+            {
+                // Files are read only now, so one can vanish after the scan: skip it as the scan would have.
+                std::vector<std::byte> data = readBinaryFile(source.filePath);
+                if (data.empty() && !fs::exists(source.filePath))
+                {
+                    std::cerr << "Missing " << source.kind << ": " << source.filePath.generic_string() << std::endl;
+                    continue;
+                }
+                if (source.validateTexture &&
+                    !validateTexturePayloadForPack(source.filePath.generic_string(), source.logicalPath, data))
+                {
+                    return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+                }
+
+                VpkWriteItem item;
+                item.logicalPath   = std::move(source.logicalPath);
+                item.uuid          = source.uuid;
+                item.type          = source.type;
+                item.bytes         = std::move(data);
+                item.allowCompress = true;
+                item.dependencies  = std::move(source.dependencies);
+                if (auto r = writer.add(std::move(item)); !r)
+                    return r;
+                ++packedCount;
+            }
+            auto r     = writer.finish();
+            writeStats = writer.stats();
+            return r;
+        }();
+
         if (!writeResult)
+        {
+            // Do not leave a truncated package behind.
+            std::error_code ec;
+            fs::remove(fs::path(std::string(outVpk)), ec);
+            for (uint32_t v = 0; options.volumeSize > 0; ++v)
+                if (!fs::remove(fs::path(vpkVolumePath(outVpk, v)), ec))
+                    break;
             return vbase::Result<size_t, AssetError>::err(writeResult.error());
+        }
+
+        if (writeStats.dedupedEntries > 0)
+            std::cout << "Deduplicated " << writeStats.dedupedEntries << " entries (" << writeStats.dedupedBytes
+                      << " bytes saved)" << std::endl;
+        if (options.codec != VpkCodec::eZstd)
+            std::cout << "Encoded " << writeStats.zstdEntries << " entries as zstd, " << writeStats.lz4Entries
+                      << " as LZ4, stored " << writeStats.storedEntries << std::endl;
 
-        return vbase::Result<size_t, AssetError>::ok(items.size());
+        return vbase::Result<size_t, AssetError>::ok(packedCount);
     }
 } // namespace vasset
@@ -1,16 +1,31 @@
-#include "vasset/vpk.hpp"
+#include "vpk_internal.hpp"
 
+#include <lz4.h>
+#include <lz4hc.h>
 #include <xxhash.h>
 #include <zstd.h>
 
+#include <zdict.h>
+
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdio>
 #include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <atomic>
+#include <map>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace vasset
 {
-    static constexpr uint32_t VPK_VERSION = 3;
+    static constexpr uint32_t VPK_VERSION = 4;
 
     static inline uint64_t hash64(std::string_view s) { return XXH3_64bits(s.data(), s.size()); }
 
@@ -44,6 +59,175 @@ namespace vasset
         return (flags & 0x1u) != 0;
     }
 
+    static inline bool should_compress(const VpkWriteItem& it)
+    {
+        vbase::ConstByteSpan bytes {it.bytes.data(), it.bytes.size()};
+        const bool already = is_already_compressed_path(it.logicalPath) || is_vmesh_already_compressed(bytes);
+        return it.allowCompress && !already && !it.bytes.empty();
+    }
+
+    static inline bool should_frame(const VpkWriteItem& it, const VpkWriteOptions& options)
+    {
+        return should_compress(it) && options.framedThreshold > 0 && options.frameSize > 0 &&
+               it.bytes.size() >= options.framedThreshold;
+    }
+
+    // Worker count for `jobs` jobs: `requested`, or hardware concurrency when 0, never more than jobs.
+    static uint32_t resolveThreadCount(uint32_t requested, size_t jobs)
+    {
+        uint32_t threads = requested;
+        if (threads == 0)
+        {
+            const auto hardware = std::thread::hardware_concurrency();
+            threads             = hardware > 0 ? hardware : 1;
+        }
+        return static_cast<uint32_t>(std::min<size_t>(threads, jobs));
+    }
+
+    // Run job(i) for i in [0, jobCount) on up to `threads` workers (inline when one suffices).
+    // Workers claim jobs in order, so jobs sorted by offset are issued roughly sequentially.
+    template<typename Job>
+    static void runJobs(size_t jobCount, uint32_t threads, Job&& job)
+    {
+        if (threads <= 1)
+        {
+            for (size_t i = 0; i < jobCount; ++i)
+                job(i);
+            return;
+        }
+
+        std::atomic<size_t>      next {0};
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (uint32_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&] {
+                for (size_t i = next.fetch_add(1); i < jobCount; i = next.fetch_add(1))
+                    job(i);
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    // Compress `raw` as independent frames of `frameSize` bytes behind a seek table (see
+    // detail::VpkFrameTable for the layout).
+    static bool packFrames(vbase::ConstByteSpan raw, int zstdLevel, uint32_t frameSize, std::vector<std::byte>& out)
+    {
+        const size_t frameCount = (raw.size() + frameSize - 1) / frameSize;
+        const size_t tableSize  = 2 * sizeof(uint32_t) + frameCount * sizeof(uint64_t);
+
+        std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+        if (!cctx)
+            return false;
+
+        out.clear();
+        out.resize(tableSize + frameCount * ZSTD_compressBound(frameSize));
+
+        std::vector<uint64_t> frameEnds(frameCount);
+        size_t                cur = tableSize;
+        for (size_t i = 0; i < frameCount; ++i)
+        {
+            const size_t begin = i * frameSize;
+            const size_t n     = std::min<size_t>(frameSize, raw.size() - begin);
+            const size_t sz =
+                ZSTD_compressCCtx(cctx.get(), out.data() + cur, out.size() - cur, raw.data() + begin, n, zstdLevel);
+            if (ZSTD_isError(sz))
+                return false;
+            cur += sz;
+            frameEnds[i] = static_cast<uint64_t>(cur - tableSize);
+        }
+        out.resize(cur);
+
+        const uint32_t head[2] = {frameSize, static_cast<uint32_t>(frameCount)};
+        std::memcpy(out.data(), head, sizeof(head));
+        if (frameCount > 0)
+            std::memcpy(out.data() + sizeof(head), frameEnds.data(), frameCount * sizeof(uint64_t));
+        return true;
+    }
+
+    // Build the directory section from the final (sorted) index. Nodes are numbered breadth-first
+    // from the root so every node's subdirectories are contiguous; subdirectories and files are
+    // sorted by name. Empty path components ("a//b") are skipped, as lookups skip them too.
+    // Tombstones belong to no directory; they fill the tail of fileOrder so it still has one slot
+    // per index entry.
+    static void buildDirectoryTable(const std::vector<VpkEntry>&   entries,
+                                    std::string_view               strtab,
+                                    std::vector<VpkDirectoryNode>& nodes,
+                                    std::vector<uint32_t>&         fileOrder)
+    {
+        struct Dir
+        {
+            uint32_t                                           nameOffset {0};
+            uint32_t                                           nameSize {0};
+            std::map<std::string_view, std::unique_ptr<Dir>>   dirs;
+            std::vector<std::pair<std::string_view, uint32_t>> files;
+        };
+
+        Dir                   root;
+        std::vector<uint32_t> tombstones;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(entries.size()); ++i)
+        {
+            const auto&            e    = entries[i];
+            const std::string_view path = strtab.substr(e.pathOffset, e.pathSize);
+            if (e.flags & kVpkEntryFlagTombstone)
+            {
+                tombstones.push_back(i);
+                continue;
+            }
+
+            Dir*   dir   = &root;
+            size_t begin = 0;
+            for (size_t slash = path.find('/'); slash != std::string_view::npos; slash = path.find('/', begin))
+            {
+                if (slash > begin)
+                {
+                    auto& child = dir->dirs[path.substr(begin, slash - begin)];
+                    if (!child)
+                    {
+                        child             = std::make_unique<Dir>();
+                        child->nameOffset = e.pathOffset + static_cast<uint32_t>(begin);
+                        child->nameSize   = static_cast<uint32_t>(slash - begin);
+                    }
+                    dir = child.get();
+                }
+                begin = slash + 1;
+            }
+            dir->files.emplace_back(path.substr(begin), i);
+        }
+
+        nodes.clear();
+        fileOrder.clear();
+
+        std::vector<const Dir*> queue {&root};
+        nodes.push_back({});
+        for (size_t q = 0; q < queue.size(); ++q)
+        {
+            const Dir* dir = queue[q];
+
+            VpkDirectoryNode& node = nodes[q];
+            node.nameOffset        = dir->nameOffset;
+            node.nameSize          = dir->nameSize;
+            node.firstDir          = static_cast<uint32_t>(nodes.size());
+            node.dirCount          = static_cast<uint32_t>(dir->dirs.size());
+            node.firstFile         = static_cast<uint32_t>(fileOrder.size());
+            node.fileCount         = static_cast<uint32_t>(dir->files.size());
+
+            auto files = dir->files;
+            std::stable_sort(
+                files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (const auto& file : files)
+                fileOrder.push_back(file.second);
+
+            for (const auto& child : dir->dirs)
+            {
+                queue.push_back(child.second.get());
+                nodes.push_back({});
+            }
+        }
+        fileOrder.insert(fileOrder.end(), tombstones.begin(), tombstones.end());
+    }
+
     struct VpkHeaderV1
     {
         char     magic[4];
@@ -66,11 +250,57 @@ namespace vasset
 
     namespace
     {
-        // Parse VPK metadata (header/index/string-table/registry) via a random-access byte reader.
-        // readAt(offset, dst, n) must copy n bytes at file offset `offset` and return false on any
-        // out-of-range / short read. Shared by the on-disk and in-memory open paths.
+        // Tables of a pack that could not be used in place (read from disk, copied out of a caller's
+        // blob, or converted from an older layout). Pins the source image too when some tables
+        // still alias it.
+        struct VpkOwnedTables
+        {
+            std::vector<VpkEntry>              entries;
+            std::vector<VpkAssetRegistryEntry> registry;
+            std::string                        stringTable;
+            std::vector<VpkSection>            sections;
+            std::vector<VpkDirectoryNode>      directories;
+            std::vector<uint32_t>              directoryFiles;
+            std::vector<uint64_t>              checksums;
+            std::vector<VpkDependencyRange>    dependencies;
+            std::vector<uint32_t>              dependencyTargets;
+            std::vector<VpkUuidIndexEntry>     uuidIndex;
+            std::vector<uint32_t>              pathBuckets;
+            std::vector<std::byte>             pathData;
+            std::vector<uint64_t>              volumeSizes;
+            std::shared_ptr<const void>        image;
+        };
+
+        // View `count` elements of T at `offset` inside an in-memory image, if they are in bounds and
+        // suitably aligned to be read in place.
+        template<typename T>
+        bool viewTable(vbase::ConstByteSpan image, uint64_t offset, uint64_t count, std::span<const T>& out)
+        {
+            if (count == 0)
+            {
+                out = {};
+                return true;
+            }
+            if (offset > image.size() || count > (image.size() - offset) / sizeof(T))
+                return false;
+
+            const std::byte* p = image.data() + offset;
+            if (reinterpret_cast<std::uintptr_t>(p) % alignof(T) != 0)
+                return false;
+
+            out = std::span<const T>(reinterpret_cast<const T*>(p), static_cast<size_t>(count));
+            return true;
+        }
+
+        // Parse VPK metadata (header/index/string-table/registry/sections) via a random-access byte
+        // reader. readAt(offset, dst, n) must copy n bytes at file offset `offset` and return false on
+        // any out-of-range / short read. Shared by the on-disk and in-memory open paths.
+        //
+        // When `image` is non-empty it is the whole pack in memory, kept alive by `imageOwner`: v4
+        // tables are then viewed in place instead of copied.
         template<typename ReadAt>
-        vbase::Result<VpkReadOnly, AssetError> parseVpk(ReadAt&& readAt)
+        vbase::Result<VpkReadOnly, AssetError>
+        parseVpk(ReadAt&& readAt, std::shared_ptr<const void> imageOwner = {}, vbase::ConstByteSpan image = {})
         {
             VpkReadOnly out {};
 
@@ -102,7 +332,13 @@ namespace vasset
                 out.header.registrySize   = 0;
                 out.header.registryCount  = 0;
             }
-            else if (version == 2 || version == VPK_VERSION)
+            else if (version == 2 || version == 3)
+            {
+                // v2/v3 headers are the v4 header without the trailing section fields.
+                if (!readAt(0, &out.header, offsetof(VpkHeader, sectionOffset)))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+            }
+            else if (version == VPK_VERSION)
             {
                 if (!readAt(0, &out.header, sizeof(VpkHeader)))
                     return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
@@ -112,304 +348,2468 @@ namespace vasset
                 return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
             }
 
-            // Index
-            out.entries.resize(out.header.fileCount);
-            if (out.header.indexSize > 0 &&
-                !readAt(out.header.indexOffset, out.entries.data(), static_cast<size_t>(out.header.indexSize)))
+            const VpkHeader& h = out.header;
+            if (h.indexSize != uint64_t {h.fileCount} * sizeof(VpkEntry))
                 return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
+            // Only the current layout is trusted in place: older packs need their entries fixed up.
+            const bool                      current = version == VPK_VERSION;
+            const bool                      inPlace = current && !image.empty();
+            std::shared_ptr<VpkOwnedTables> owned;
+            auto                            ownTables = [&]() -> VpkOwnedTables& {
+                if (!owned)
+                    owned = std::make_shared<VpkOwnedTables>();
+                return *owned;
+            };
+
+            // Index
+            const bool sorted = current && (h.flags & kVpkFlagSortedIndex) != 0;
+            if (!inPlace || !sorted || !viewTable(image, h.indexOffset, h.fileCount, out.entries))
+            {
+                auto& entries = ownTables().entries;
+                entries.resize(h.fileCount);
+                if (h.indexSize > 0 && !readAt(h.indexOffset, entries.data(), static_cast<size_t>(h.indexSize)))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+
+                // Older writers left the tail of VpkEntry as unspecified padding.
+                if (version < 4)
+                {
+                    for (auto& e : entries)
+                    {
+                        e.dictionary = 0;
+                        e.flags      = 0;
+                        e.reserved0  = 0;
+                        e.volume     = 0;
+                    }
+                }
+
+                if (!sorted)
+                    std::stable_sort(entries.begin(), entries.end(), [](const VpkEntry& a, const VpkEntry& b) {
+                        return a.pathHash64 < b.pathHash64;
+                    });
+                out.entries = entries;
+            }
+
+            if (const uint64_t alignment = vpkPayloadAlignment(h); alignment > 1)
+            {
+                for (const auto& e : out.entries)
+                    if (e.packedSize > 0 && e.dataOffset % alignment != 0)
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+            }
+
             // String table
-            out.stringTable.resize(static_cast<size_t>(out.header.stringSize));
-            if (out.header.stringSize > 0 &&
-                !readAt(out.header.stringOffset, out.stringTable.data(), static_cast<size_t>(out.header.stringSize)))
-                return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+            if (inPlace && h.stringOffset <= image.size() && h.stringSize <= image.size() - h.stringOffset)
+            {
+                out.stringTable = std::string_view(reinterpret_cast<const char*>(image.data() + h.stringOffset),
+                                                   static_cast<size_t>(h.stringSize));
+            }
+            else
+            {
+                auto& stringTable = ownTables().stringTable;
+                stringTable.resize(static_cast<size_t>(h.stringSize));
+                if (h.stringSize > 0 &&
+                    !readAt(h.stringOffset, stringTable.data(), static_cast<size_t>(h.stringSize)))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                out.stringTable = stringTable;
+            }
 
             // Registry (v2+)
-            if (out.header.registryCount > 0 && out.header.registrySize > 0)
+            if (h.registryCount > 0 && h.registrySize > 0)
             {
                 if (version == 2)
                 {
                     std::vector<VpkAssetRegistryEntryV2> registryV2;
-                    registryV2.resize(static_cast<size_t>(out.header.registryCount));
-                    if (!readAt(out.header.registryOffset,
-                                registryV2.data(),
-                                static_cast<size_t>(out.header.registrySize)))
+                    registryV2.resize(static_cast<size_t>(h.registryCount));
+                    if (!readAt(h.registryOffset, registryV2.data(), static_cast<size_t>(h.registrySize)))
                         return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-                    out.registry.reserve(registryV2.size());
+                    auto& registry = ownTables().registry;
+                    registry.reserve(registryV2.size());
                     for (const auto& r2 : registryV2)
                     {
                         VpkAssetRegistryEntry r {};
                         r.uuid       = r2.uuid;
                         r.pathOffset = r2.pathOffset;
                         r.pathSize   = r2.pathSize;
-                        out.registry.push_back(r);
+                        registry.push_back(r);
                     }
+                    out.registry = registry;
                 }
-                else
+                else if (!inPlace || !viewTable(image, h.registryOffset, h.registryCount, out.registry))
                 {
-                    out.registry.resize(static_cast<size_t>(out.header.registryCount));
-                    if (!readAt(out.header.registryOffset,
-                                out.registry.data(),
-                                static_cast<size_t>(out.header.registrySize)))
+                    auto& registry = ownTables().registry;
+                    registry.resize(static_cast<size_t>(h.registryCount));
+                    if (!readAt(h.registryOffset, registry.data(), static_cast<size_t>(h.registrySize)))
                         return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    out.registry = registry;
                 }
             }
 
-            for (uint32_t i = 0; i < static_cast<uint32_t>(out.entries.size()); ++i)
-                out.buckets[out.entries[i].pathHash64].push_back(i);
+            // Sections (v4+). Unknown kinds are kept in `sections` but otherwise ignored.
+            if (h.sectionCount > 0 && (!inPlace || !viewTable(image, h.sectionOffset, h.sectionCount, out.sections)))
+            {
+                auto& sections = ownTables().sections;
+                sections.resize(h.sectionCount);
+                if (!readAt(h.sectionOffset, sections.data(), sections.size() * sizeof(VpkSection)))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                out.sections = sections;
+            }
 
-            return vbase::Result<VpkReadOnly, AssetError>::ok(std::move(out));
-        }
+            for (const auto& section : out.sections)
+            {
+                if (section.kind != VpkSectionKind::eDirectories)
+                    continue;
 
-        // Decompress (or copy) a packed entry payload into its raw bytes.
-        vbase::Result<std::vector<std::byte>, AssetError> unpackEntry(const VpkEntry& e, std::vector<std::byte> packed)
-        {
-            if (e.compression == VpkCompression::eNone)
-                return vbase::Result<std::vector<std::byte>, AssetError>::ok(std::move(packed));
+                const uint64_t nodesSize = uint64_t {section.count} * sizeof(VpkDirectoryNode);
+                if (section.size != nodesSize + uint64_t {h.fileCount} * sizeof(uint32_t))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-            if (e.compression != VpkCompression::eZstd)
-                return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eNotSupported);
+                if (!inPlace || !viewTable(image, section.offset, section.count, out.directories) ||
+                    !viewTable(image, section.offset + nodesSize, h.fileCount, out.directoryFiles))
+                {
+                    auto& tables = ownTables();
+                    tables.directories.resize(section.count);
+                    tables.directoryFiles.resize(h.fileCount);
+                    if (!readAt(section.offset, tables.directories.data(), static_cast<size_t>(nodesSize)) ||
+                        (h.fileCount > 0 && !readAt(section.offset + nodesSize,
+                                                    tables.directoryFiles.data(),
+                                                    tables.directoryFiles.size() * sizeof(uint32_t))))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    out.directories    = tables.directories;
+                    out.directoryFiles = tables.directoryFiles;
+                }
+            }
 
-            std::vector<std::byte> raw;
-            raw.resize(static_cast<size_t>(e.rawSize));
+            for (const auto& section : out.sections)
+            {
+                if (section.kind != VpkSectionKind::eChecksums)
+                    continue;
 
-            const size_t r = ZSTD_decompress(raw.data(), raw.size(), packed.data(), packed.size());
-            if (ZSTD_isError(r) || r != raw.size())
-                return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eInvalidFormat);
+                if (section.count != h.fileCount || section.size != uint64_t {h.fileCount} * sizeof(uint64_t))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-            return vbase::Result<std::vector<std::byte>, AssetError>::ok(std::move(raw));
-        }
-    } // namespace
+                if (!inPlace || !viewTable(image, section.offset, section.count, out.checksums))
+                {
+                    auto& checksums = ownTables().checksums;
+                    checksums.resize(section.count);
+                    if (section.size > 0 &&
+                        !readAt(section.offset, checksums.data(), static_cast<size_t>(section.size)))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    out.checksums = checksums;
+                }
+            }
 
-    vbase::Result<VpkReadOnly, AssetError> openVpk(vbase::StringView vpkPath)
-    {
-        std::ifstream f(std::string(vpkPath), std::ios::binary);
-        if (!f)
-            return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eNotFound);
+            for (const auto& section : out.sections)
+            {
+                if (section.kind != VpkSectionKind::eDependencies)
+                    continue;
 
-        return parseVpk([&f](uint64_t offset, void* dst, size_t n) -> bool {
-            f.clear();
-            f.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
-            f.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n));
-            return static_cast<bool>(f);
-        });
-    }
+                const uint64_t rangesSize = uint64_t {section.count} * sizeof(VpkDependencyRange);
+                if (section.count != out.registry.size() || section.size < rangesSize ||
+                    (section.size - rangesSize) % sizeof(uint32_t) != 0)
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-    vbase::Result<VpkReadOnly, AssetError> openVpkFromMemory(vbase::ConstByteSpan blob)
-    {
-        return parseVpk([blob](uint64_t offset, void* dst, size_t n) -> bool {
-            if (offset > blob.size() || n > blob.size() - offset)
-                return false;
-            std::memcpy(dst, blob.data() + offset, n);
-            return true;
-        });
-    }
+                const uint64_t targetCount = (section.size - rangesSize) / sizeof(uint32_t);
+                if (!inPlace || !viewTable(image, section.offset, section.count, out.dependencies) ||
+                    !viewTable(image, section.offset + rangesSize, targetCount, out.dependencyTargets))
+                {
+                    auto& tables = ownTables();
+                    tables.dependencies.resize(section.count);
+                    tables.dependencyTargets.resize(static_cast<size_t>(targetCount));
+                    if ((rangesSize > 0 &&
+                         !readAt(section.offset, tables.dependencies.data(), static_cast<size_t>(rangesSize))) ||
+                        (targetCount > 0 && !readAt(section.offset + rangesSize,
+                                                    tables.dependencyTargets.data(),
+                                                    tables.dependencyTargets.size() * sizeof(uint32_t))))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    out.dependencies      = tables.dependencies;
+                    out.dependencyTargets = tables.dependencyTargets;
+                }
 
-    static vbase::Result<const VpkEntry*, AssetError> find_entry(const VpkReadOnly& vpk, std::string_view logicalPath)
-    {
-        const uint64_t h  = hash64(logicalPath);
-        auto           it = vpk.buckets.find(h);
-        if (it == vpk.buckets.end())
-            return vbase::Result<const VpkEntry*, AssetError>::err(AssetError::eNotFound);
+                for (const auto& range : out.dependencies)
+                    if (range.first > targetCount || range.count > targetCount - range.first)
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                for (const uint32_t target : out.dependencyTargets)
+                    if (target >= out.registry.size())
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+            }
 
-        for (uint32_t idx : it->second)
-        {
-            const auto& e = vpk.entries[idx];
-            if (e.pathOffset + e.pathSize > vpk.stringTable.size())
-                continue;
+            for (const auto& section : out.sections)
+            {
+                if (section.kind != VpkSectionKind::eUuidIndex)
+                    continue;
 
-            const char* s = vpk.stringTable.data() + e.pathOffset;
-            if (std::string_view(s, e.pathSize) == logicalPath)
-                return vbase::Result<const VpkEntry*, AssetError>::ok(&e);
-        }
+                if (section.size != uint64_t {section.count} * sizeof(VpkUuidIndexEntry))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-        return vbase::Result<const VpkEntry*, AssetError>::err(AssetError::eNotFound);
-    }
+                if (!inPlace || !viewTable(image, section.offset, section.count, out.uuidIndex))
+                {
+                    auto& uuidIndex = ownTables().uuidIndex;
+                    uuidIndex.resize(section.count);
+                    if (section.size > 0 &&
+                        !readAt(section.offset, uuidIndex.data(), static_cast<size_t>(section.size)))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    out.uuidIndex = uuidIndex;
+                }
 
-    vbase::Result<std::vector<std::byte>, AssetError>
-    readVpkFile(const VpkReadOnly& vpk, vbase::StringView vpkPath, vbase::StringView logicalPath)
-    {
-        if (!logicalPath.empty() && logicalPath.front() == '/')
-            logicalPath.remove_prefix(1);
+                for (const auto& row : out.uuidIndex)
+                    if (row.entry >= out.entries.size() || row.registry >= out.registry.size())
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+            }
 
-        auto fe = find_entry(vpk, std::string_view(logicalPath.data(), logicalPath.size()));
-        if (!fe)
-            return vbase::Result<std::vector<std::byte>, AssetError>::err(fe.error());
+            // Front-coded paths: one bucket per kVpkPathBucketSize index entries.
+            if (h.flags & kVpkFlagFrontCodedPaths)
+            {
+                const auto section = std::find_if(out.sections.begin(), out.sections.end(), [](const VpkSection& s) {
+                    return s.kind == VpkSectionKind::ePathBuckets;
+                });
+                const uint64_t bucketCount = (uint64_t {h.fileCount} + kVpkPathBucketSize - 1) / kVpkPathBucketSize;
+                if (!current || section == out.sections.end() || section->count != bucketCount ||
+                    section->size < bucketCount * sizeof(uint32_t))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-        const VpkEntry& e = *fe.value();
+                const uint64_t offsetsSize = bucketCount * sizeof(uint32_t);
+                const uint64_t dataSize    = section->size - offsetsSize;
+                if (!inPlace || !viewTable(image, section->offset, bucketCount, out.pathBuckets) ||
+                    !viewTable(image, section->offset + offsetsSize, dataSize, out.pathData))
+                {
+                    auto& tables = ownTables();
+                    tables.pathBuckets.resize(static_cast<size_t>(bucketCount));
+                    tables.pathData.resize(static_cast<size_t>(dataSize));
+                    if ((offsetsSize > 0 &&
+                         !readAt(section->offset, tables.pathBuckets.data(), static_cast<size_t>(offsetsSize))) ||
+                        (dataSize > 0 &&
+                         !readAt(section->offset + offsetsSize, tables.pathData.data(), static_cast<size_t>(dataSize))))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    out.pathBuckets = tables.pathBuckets;
+                    out.pathData    = tables.pathData;
+                }
 
-        std::ifstream f(std::string(vpkPath), std::ios::binary);
-        if (!f)
-            return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eNotFound);
+                for (size_t i = 0; i < out.pathBuckets.size(); ++i)
+                    if (out.pathBuckets[i] > dataSize || (i > 0 && out.pathBuckets[i] < out.pathBuckets[i - 1]))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                out.pathNames = std::make_shared<VpkPathNames>();
+            }
 
-        f.seekg(static_cast<std::streamoff>(e.dataOffset), std::ios::beg);
+            // Volume sizes, one per volume file (at most kVpkMaxVolumes).
+            if (h.flags & kVpkFlagVolumes)
+            {
+                const auto section = std::find_if(out.sections.begin(), out.sections.end(), [](const VpkSection& s) {
+                    return s.kind == VpkSectionKind::eVolumes;
+                });
+                if (!current || section == out.sections.end() || section->count > kVpkMaxVolumes ||
+                    section->size != uint64_t {section->count} * sizeof(uint64_t))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-        std::vector<std::byte> packed;
-        packed.resize(static_cast<size_t>(e.packedSize));
-        if (e.packedSize > 0)
-        {
-            f.read(reinterpret_cast<char*>(packed.data()), static_cast<std::streamsize>(e.packedSize));
-            if (!f)
-                return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eIOError);
-        }
+                if (!inPlace || !viewTable(image, section->offset, section->count, out.volumeSizes))
+                {
+                    auto& volumeSizes = ownTables().volumeSizes;
+                    volumeSizes.resize(section->count);
+                    if (section->size > 0 &&
+                        !readAt(section->offset, volumeSizes.data(), static_cast<size_t>(section->size)))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    out.volumeSizes = volumeSizes;
+                }
+            }
 
-        return unpackEntry(e, std::move(packed));
-    }
+            for (const auto& section : out.sections)
+            {
+                if (section.kind != VpkSectionKind::eDictionaries)
+                    continue;
 
-    vbase::Result<std::vector<std::byte>, AssetError>
-    readVpkFileFromMemory(const VpkReadOnly& vpk, vbase::ConstByteSpan blob, vbase::StringView logicalPath)
-    {
-        if (!logicalPath.empty() && logicalPath.front() == '/')
-            logicalPath.remove_prefix(1);
+                if (section.size != uint64_t {section.count} * sizeof(VpkDictionaryEntry))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-        auto fe = find_entry(vpk, std::string_view(logicalPath.data(), logicalPath.size()));
-        if (!fe)
-            return vbase::Result<std::vector<std::byte>, AssetError>::err(fe.error());
+                auto dicts = std::make_shared<VpkDictionaries>();
+                dicts->entries.resize(section.count);
+                if (section.size > 0 &&
+                    !readAt(section.offset, dicts->entries.data(), static_cast<size_t>(section.size)))
+                    return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-        const VpkEntry& e = *fe.value();
+                std::vector<std::byte> body;
+                for (const auto& d : dicts->entries)
+                {
+                    body.resize(static_cast<size_t>(d.size));
+                    if (!readAt(d.offset, body.data(), body.size()))
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
 
-        if (e.dataOffset > blob.size() || e.packedSize > blob.size() - e.dataOffset)
-            return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eInvalidFormat);
+                    detail::ZstdDDictPtr ddict {ZSTD_createDDict(body.data(), body.size())};
+                    if (!ddict)
+                        return vbase::Result<VpkReadOnly, AssetError>::err(AssetError::eInvalidFormat);
+                    dicts->ddicts.push_back(std::move(ddict));
+                }
+                out.dictionaries = std::move(dicts);
+            }
 
-        std::vector<std::byte> packed;
-        packed.resize(static_cast<size_t>(e.packedSize));
-        if (e.packedSize > 0)
-            std::memcpy(packed.data(), blob.data() + e.dataOffset, static_cast<size_t>(e.packedSize));
+            if (owned)
+            {
+                owned->image = std::move(imageOwner);
+                out.storage  = std::move(owned);
+            }
+            else
+            {
+                out.storage = std::move(imageOwner);
+            }
 
-        return unpackEntry(e, std::move(packed));
-    }
+            return vbase::Result<VpkReadOnly, AssetError>::ok(std::move(out));
+        }
 
-    vbase::Result<void, AssetError>
-    writeVpk(vbase::StringView outPath, const std::vector<VpkWriteItem>& items, int zstdLevel)
-    {
-        std::filesystem::path p(outPath);
-        if (p.has_parent_path())
-            std::filesystem::create_directories(p.parent_path());
+        // Decode every frame of an eZstdFrames payload into one contiguous buffer.
+        vbase::Result<void, AssetError> unpackFrames(const ZSTD_DDict*       ddict,
+                                                     const VpkEntry&         e,
+                                                     vbase::ConstByteSpan    packed,
+                                                     std::vector<std::byte>& raw)
+        {
+            auto readPackedAt = [packed](uint64_t offset, void* dst, size_t n) -> bool {
+                if (offset > packed.size() || n > packed.size() - offset)
+                    return false;
+                std::memcpy(dst, packed.data() + offset, n);
+                return true;
+            };
 
-        std::ofstream f(std::string(outPath), std::ios::binary);
-        if (!f)
-            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+            detail::VpkFrameTable table;
+            if (!detail::readFrameTable(e, readPackedAt, table))
+                return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
 
-        // String table
-        std::string strtab;
-        strtab.reserve(1024);
-
-        std::vector<VpkEntry> entries;
-        entries.reserve(items.size());
-
-        std::vector<VpkAssetRegistryEntry> registry;
-        registry.reserve(items.size());
-
-        // Header placeholder
-        VpkHeader hdr {};
-        std::memcpy(hdr.magic, "VPK\0", 4);
-        hdr.version   = VPK_VERSION;
-        hdr.flags     = 0;
-        hdr.fileCount = static_cast<uint32_t>(items.size());
-
-        f.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
-
-        hdr.dataOffset   = sizeof(hdr);
-        uint64_t curData = hdr.dataOffset;
-
-        // Data blob
-        for (const auto& it : items)
-        {
-            VpkEntry e {};
-            e.pathHash64 = hash64(it.logicalPath);
-
-            e.pathOffset = static_cast<uint32_t>(strtab.size());
-            e.pathSize   = static_cast<uint32_t>(it.logicalPath.size());
-            strtab.append(it.logicalPath.data(), it.logicalPath.size());
-            strtab.push_back('\0');
-
-            // Registry entry: UUID -> (string table path)
-            VpkAssetRegistryEntry r {};
-            r.uuid       = it.uuid;
-            r.pathOffset = e.pathOffset;
-            r.pathSize   = e.pathSize;
-            r.type       = it.type;
-            registry.push_back(r);
-
-            vbase::ConstByteSpan bytes {it.bytes.data(), it.bytes.size()};
-            const bool already    = is_already_compressed_path(it.logicalPath) || is_vmesh_already_compressed(bytes);
-            const bool doCompress = it.allowCompress && !already && !it.bytes.empty();
-
-            std::vector<std::byte> packed;
-            if (doCompress)
-            {
-                const size_t bound = ZSTD_compressBound(it.bytes.size());
-                packed.resize(bound);
-                const size_t sz =
-                    ZSTD_compress(packed.data(), packed.size(), it.bytes.data(), it.bytes.size(), zstdLevel);
-                if (ZSTD_isError(sz))
-                    return vbase::Result<void, AssetError>::err(AssetError::eIOError);
-                packed.resize(sz);
+            raw.resize(static_cast<size_t>(e.rawSize));
 
-                e.compression = VpkCompression::eZstd;
-                e.rawSize     = static_cast<uint64_t>(it.bytes.size());
-                e.packedSize  = static_cast<uint64_t>(packed.size());
-            }
-            else
+            for (size_t i = 0; i < table.frameCount(); ++i)
             {
-                e.compression = VpkCompression::eNone;
-                e.rawSize     = static_cast<uint64_t>(it.bytes.size());
-                e.packedSize  = static_cast<uint64_t>(it.bytes.size());
+                const uint64_t begin = table.rawBegin(i);
+                const size_t   want  = static_cast<size_t>(std::min<uint64_t>(table.frameRawSize, e.rawSize - begin));
+                const size_t   at    = static_cast<size_t>(table.packedBegin(i));
+                const size_t   n     = static_cast<size_t>(table.packedEnd(i) - table.packedBegin(i));
+
+                if (!detail::decompressFrame(
+                        detail::threadDCtx(), ddict, raw.data() + begin, want, packed.data() + at, n))
+                    return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
             }
 
-            e.dataOffset = curData;
+            return vbase::Result<void, AssetError>::ok();
+        }
+
+        // Whether `raw` matches the checksum stored for `e`, which must point into vpk.entries. Entries
+        // of packs without checksums always match.
+        bool entryChecksumMatches(const VpkReadOnly& vpk, const VpkEntry& e, vbase::ConstByteSpan raw)
+        {
+            if (vpk.checksums.empty() || &e < vpk.entries.data() || &e >= vpk.entries.data() + vpk.entries.size())
+                return true;
+            return XXH3_64bits(raw.data(), raw.size()) == vpk.checksums[static_cast<size_t>(&e - vpk.entries.data())];
+        }
 
-            if (doCompress)
+        vbase::Result<void, AssetError> decodeEntryInto(const VpkReadOnly&      vpk,
+                                                        const VpkEntry&         e,
+                                                        vbase::ConstByteSpan    packed,
+                                                        std::vector<std::byte>& raw)
+        {
+            if (e.compression == VpkCompression::eNone)
             {
-                f.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
-                curData += static_cast<uint64_t>(packed.size());
+                raw.assign(packed.begin(), packed.end());
+                return vbase::Result<void, AssetError>::ok();
             }
-            else
+
+            if (e.compression == VpkCompression::eLz4)
             {
-                if (!it.bytes.empty())
-                {
-                    f.write(reinterpret_cast<const char*>(it.bytes.data()),
-                            static_cast<std::streamsize>(it.bytes.size()));
-                    curData += static_cast<uint64_t>(it.bytes.size());
-                }
+                if (e.rawSize > LZ4_MAX_INPUT_SIZE || packed.size() > static_cast<size_t>(INT32_MAX))
+                    return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+
+                raw.resize(static_cast<size_t>(e.rawSize));
+                const int n = LZ4_decompress_safe(reinterpret_cast<const char*>(packed.data()),
+                                                  reinterpret_cast<char*>(raw.data()),
+                                                  static_cast<int>(packed.size()),
+                                                  static_cast<int>(raw.size()));
+                if (n < 0 || static_cast<size_t>(n) != raw.size())
+                    return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+                return vbase::Result<void, AssetError>::ok();
             }
 
-            entries.push_back(e);
+            const ZSTD_DDict* ddict = nullptr;
+            if (!detail::entryDDict(vpk, e, ddict))
+                return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+
+            if (e.compression == VpkCompression::eZstdFrames)
+                return unpackFrames(ddict, e, packed, raw);
+
+            if (e.compression != VpkCompression::eZstd)
+                return vbase::Result<void, AssetError>::err(AssetError::eNotSupported);
+
+            raw.resize(static_cast<size_t>(e.rawSize));
+
+            if (!detail::decompressFrame(
+                    detail::threadDCtx(), ddict, raw.data(), raw.size(), packed.data(), packed.size()))
+                return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+
+            return vbase::Result<void, AssetError>::ok();
         }
 
-        // String table
-        hdr.stringOffset = curData;
-        hdr.stringSize   = static_cast<uint64_t>(strtab.size());
-        if (!strtab.empty())
+        // Decompress (or copy) a packed entry payload into `raw`. The vector is resized to the raw size,
+        // so a caller that keeps it around reuses its capacity.
+        vbase::Result<void, AssetError> unpackEntryInto(const VpkReadOnly&      vpk,
+                                                        const VpkEntry&         e,
+                                                        vbase::ConstByteSpan    packed,
+                                                        std::vector<std::byte>& raw)
         {
-            f.write(strtab.data(), static_cast<std::streamsize>(strtab.size()));
-            curData += static_cast<uint64_t>(strtab.size());
+            if (auto r = decodeEntryInto(vpk, e, packed, raw); !r)
+                return r;
+            if (vpk.verifyOnRead && !entryChecksumMatches(vpk, e, raw))
+                return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+            return vbase::Result<void, AssetError>::ok();
         }
 
-        // Index
-        hdr.indexOffset = curData;
-        hdr.indexSize   = static_cast<uint32_t>(entries.size() * sizeof(VpkEntry));
-        if (!entries.empty())
+        vbase::Result<std::vector<std::byte>, AssetError>
+        unpackEntry(const VpkReadOnly& vpk, const VpkEntry& e, vbase::ConstByteSpan packed)
         {
-            f.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(hdr.indexSize));
-            curData += hdr.indexSize;
+            std::vector<std::byte> raw;
+            if (auto r = unpackEntryInto(vpk, e, packed, raw); !r)
+                return vbase::Result<std::vector<std::byte>, AssetError>::err(r.error());
+            return vbase::Result<std::vector<std::byte>, AssetError>::ok(std::move(raw));
         }
 
-        // Registry
-        hdr.registryOffset = curData;
-        hdr.registrySize   = static_cast<uint32_t>(registry.size() * sizeof(VpkAssetRegistryEntry));
-        hdr.registryCount  = static_cast<uint32_t>(registry.size());
-        if (!registry.empty())
+        // Payload order on disk: by volume, then by offset within it.
+        bool payloadBefore(const VpkEntry& a, const VpkEntry& b)
         {
-            f.write(reinterpret_cast<const char*>(registry.data()), static_cast<std::streamsize>(hdr.registrySize));
-            curData += hdr.registrySize;
+            return a.volume != b.volume ? a.volume < b.volume : a.dataOffset < b.dataOffset;
         }
 
-        // Patch header
-        f.seekp(0, std::ios::beg);
-        f.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        // Read an entry's packed bytes from disk: through the shared handle (or the entry's volume) when
+        // the package has one, otherwise through a one-off stream on `vpkPath`. Volume payloads are only
+        // read through the volume set openVpk attaches.
+        bool readPacked(const VpkReadOnly& vpk, vbase::StringView vpkPath, const VpkEntry& e, std::byte* dst)
+        {
+            if (e.packedSize == 0)
+                return true;
 
-        return vbase::Result<void, AssetError>::ok();
+            if (auto file = detail::payloadFile(vpk, e))
+                return file->readAt(e.dataOffset, dst, static_cast<size_t>(e.packedSize));
+            if (vpk.header.flags & kVpkFlagVolumes)
+                return false;
+
+            std::ifstream f(std::string(vpkPath), std::ios::binary);
+            if (!f)
+                return false;
+            f.seekg(static_cast<std::streamoff>(e.dataOffset), std::ios::beg);
+            f.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(e.packedSize));
+            return static_cast<bool>(f);
+        }
+    } // namespace
+
+    namespace detail
+    {
+        ZSTD_DCtx* threadDCtx()
+        {
+            thread_local ZstdDCtxPtr ctx {ZSTD_createDCtx()};
+            return ctx.get();
+        }
+
+        namespace
+        {
+            // Size classes 4 KiB .. 16 MiB. A thread keeps a few buffers per class and at most
+            // kScratchRetainLimit bytes overall, so an idle streaming thread stays cheap.
+            constexpr unsigned kScratchMinShift    = 12;
+            constexpr unsigned kScratchClassCount  = 13;
+            constexpr size_t   kScratchPerClass    = 4;
+            constexpr size_t   kScratchRetainLimit = 32u << 20;
+
+            struct ScratchPool
+            {
+                std::array<std::vector<std::vector<std::byte>>, kScratchClassCount> free;
+                size_t                                                             retained {0};
+            };
+
+            ScratchPool& threadScratchPool()
+            {
+                thread_local ScratchPool pool;
+                return pool;
+            }
+
+            // The class whose buffers hold `size` bytes, or kScratchClassCount when none does.
+            unsigned scratchClass(size_t size)
+            {
+                const unsigned shift = static_cast<unsigned>(std::bit_width(std::max<size_t>(size, 1) - 1));
+                return std::max(shift, kScratchMinShift) - kScratchMinShift;
+            }
+        } // namespace
+
+        ScratchBuffer::ScratchBuffer(size_t size) : m_Size(size)
+        {
+            const unsigned cls = scratchClass(size);
+            if (cls >= kScratchClassCount)
+            {
+                m_Bytes.resize(size);
+                return;
+            }
+
+            auto& pool = threadScratchPool();
+            auto& free = pool.free[cls];
+            if (!free.empty())
+            {
+                m_Bytes = std::move(free.back());
+                free.pop_back();
+                pool.retained -= m_Bytes.size();
+                return;
+            }
+            m_Bytes.resize(size_t {1} << (cls + kScratchMinShift));
+        }
+
+        ScratchBuffer::~ScratchBuffer()
+        {
+            const unsigned cls = scratchClass(m_Bytes.size());
+            if (cls >= kScratchClassCount || m_Bytes.size() != size_t {1} << (cls + kScratchMinShift))
+                return;
+
+            auto& pool = threadScratchPool();
+            auto& free = pool.free[cls];
+            if (free.size() >= kScratchPerClass || pool.retained + m_Bytes.size() > kScratchRetainLimit)
+                return;
+
+            pool.retained += m_Bytes.size();
+            free.push_back(std::move(m_Bytes));
+        }
+
+        bool entryDDict(const VpkReadOnly& vpk, const VpkEntry& e, const ZSTD_DDict*& out)
+        {
+            out = nullptr;
+            if (e.dictionary == 0)
+                return true;
+            if (!vpk.dictionaries || e.dictionary > vpk.dictionaries->ddicts.size())
+                return false;
+            out = vpk.dictionaries->ddicts[e.dictionary - 1].get();
+            return true;
+        }
+
+        bool decompressFrame(ZSTD_DCtx*        dctx,
+                             const ZSTD_DDict* ddict,
+                             void*             dst,
+                             size_t            dstSize,
+                             const void*       src,
+                             size_t            srcSize)
+        {
+            const size_t r = ddict ? ZSTD_decompress_usingDDict(dctx, dst, dstSize, src, srcSize, ddict) :
+                                     ZSTD_decompressDCtx(dctx, dst, dstSize, src, srcSize);
+            return !ZSTD_isError(r) && r == dstSize;
+        }
+    } // namespace detail
+
+    vbase::Result<VpkReadOnly, AssetError> openVpk(vbase::StringView vpkPath)
+    {
+        auto opened = VpkFileHandle::open(vpkPath);
+        if (!opened)
+            return vbase::Result<VpkReadOnly, AssetError>::err(opened.error());
+
+        std::shared_ptr<const VpkFileHandle> file = std::move(opened).value();
+
+        auto parsed = parseVpk([&file](uint64_t offset, void* dst, size_t n) -> bool {
+            return file->readAt(offset, dst, n);
+        });
+        if (!parsed)
+            return parsed;
+
+        VpkReadOnly out = std::move(parsed).value();
+        out.file        = std::move(file);
+        if (out.header.flags & kVpkFlagVolumes)
+            out.volumes = std::make_shared<VpkVolumes>(std::string(vpkPath), out.volumeSizes);
+        return vbase::Result<VpkReadOnly, AssetError>::ok(std::move(out));
+    }
+
+    std::string vpkVolumePath(vbase::StringView vpkPath, uint32_t index)
+    {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), ".%03u", index);
+        return std::string(vpkPath) + suffix;
+    }
+
+    VpkVolumes::VpkVolumes(std::string vpkPath, std::span<const uint64_t> sizes) :
+        m_Path(std::move(vpkPath)), m_Sizes(sizes.begin(), sizes.end()), m_Handles(sizes.size())
+    {}
+
+    std::shared_ptr<const VpkFileHandle> VpkVolumes::handle(uint32_t index) const
+    {
+        if (index >= m_Sizes.size())
+            return nullptr;
+
+        std::lock_guard lock(m_Mutex);
+        if (!m_Handles[index])
+        {
+            auto opened = VpkFileHandle::open(vpkVolumePath(m_Path, index));
+            if (!opened || opened.value()->size() != m_Sizes[index])
+                return nullptr;
+            m_Handles[index] = std::move(opened).value();
+        }
+        return m_Handles[index];
+    }
+
+    namespace detail
+    {
+        std::shared_ptr<const VpkFileHandle> payloadFile(const VpkReadOnly& vpk, const VpkEntry& e)
+        {
+            if (vpk.header.flags & kVpkFlagVolumes)
+                return vpk.volumes ? vpk.volumes->handle(e.volume) : nullptr;
+            return vpk.file;
+        }
+    } // namespace detail
+
+    vbase::Result<VpkReadOnly, AssetError> openVpkFromMemory(vbase::ConstByteSpan blob)
+    {
+        return parseVpk([blob](uint64_t offset, void* dst, size_t n) -> bool {
+            if (offset > blob.size() || n > blob.size() - offset)
+                return false;
+            std::memcpy(dst, blob.data() + offset, n);
+            return true;
+        });
+    }
+
+    vbase::Result<VpkReadOnly, AssetError> openVpkFromImage(std::shared_ptr<const void> owner,
+                                                            vbase::ConstByteSpan        image)
+    {
+        auto readAt = [image](uint64_t offset, void* dst, size_t n) -> bool {
+            if (offset > image.size() || n > image.size() - offset)
+                return false;
+            std::memcpy(dst, image.data() + offset, n);
+            return true;
+        };
+        return parseVpk(readAt, std::move(owner), image);
+    }
+
+    namespace
+    {
+        // Front-coded path buckets are runs of (varint shared, varint suffix size, suffix bytes): each
+        // path is the first `shared` bytes of the one before plus its suffix. The bucket head shares 0.
+        void appendVarint(std::string& out, uint64_t value)
+        {
+            for (; value >= 0x80; value >>= 7)
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            out.push_back(static_cast<char>(value));
+        }
+
+        bool readVarint(const std::byte*& p, const std::byte* end, uint64_t& value)
+        {
+            value = 0;
+            for (uint32_t shift = 0; p != end && shift < 64; shift += 7)
+            {
+                const auto b = static_cast<uint8_t>(*p++);
+                value |= uint64_t {b & 0x7Fu} << shift;
+                if (!(b & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        // Decode path `rank` of a front-coded package into `out`, walking its bucket from the head.
+        bool decodeFrontCodedPath(const VpkReadOnly& vpk, uint32_t rank, std::string& out)
+        {
+            const size_t bucket = rank / kVpkPathBucketSize;
+            if (bucket >= vpk.pathBuckets.size())
+                return false;
+
+            const bool       tail = bucket + 1 == vpk.pathBuckets.size();
+            const std::byte* p    = vpk.pathData.data() + vpk.pathBuckets[bucket];
+            const std::byte* end  = vpk.pathData.data() + (tail ? vpk.pathData.size() : vpk.pathBuckets[bucket + 1]);
+            out.clear();
+            for (uint32_t i = 0; i <= rank % kVpkPathBucketSize; ++i)
+            {
+                uint64_t shared = 0;
+                uint64_t suffix = 0;
+                if (!readVarint(p, end, shared) || !readVarint(p, end, suffix) || shared > out.size() ||
+                    suffix > static_cast<uint64_t>(end - p))
+                    return false;
+                out.resize(static_cast<size_t>(shared));
+                out.append(reinterpret_cast<const char*>(p), static_cast<size_t>(suffix));
+                p += suffix;
+            }
+            return true;
+        }
+
+        std::string_view pathAt(const VpkReadOnly& vpk, uint32_t pathOffset, uint32_t pathSize, std::string& scratch)
+        {
+            if (vpk.header.flags & kVpkFlagFrontCodedPaths)
+            {
+                if (!decodeFrontCodedPath(vpk, pathOffset, scratch) || scratch.size() != pathSize)
+                    return {};
+                return scratch;
+            }
+            if (uint64_t {pathOffset} + pathSize > vpk.stringTable.size())
+                return {};
+            return vpk.stringTable.substr(pathOffset, pathSize);
+        }
+    } // namespace
+
+    std::string_view vpkPathOf(const VpkReadOnly& vpk, const VpkEntry& e, std::string& scratch)
+    {
+        return pathAt(vpk, e.pathOffset, e.pathSize, scratch);
+    }
+
+    std::string_view vpkPathOf(const VpkReadOnly& vpk, const VpkAssetRegistryEntry& r, std::string& scratch)
+    {
+        return pathAt(vpk, r.pathOffset, r.pathSize, scratch);
+    }
+
+    std::string_view VpkPathNames::path(const VpkReadOnly& vpk, uint32_t rank, uint32_t size)
+    {
+        std::lock_guard lock(m_Mutex);
+        auto [it, inserted] = m_Paths.try_emplace(rank);
+        if (inserted && (!decodeFrontCodedPath(vpk, rank, it->second) || it->second.size() != size))
+            it->second.clear();
+        return it->second;
+    }
+
+    namespace detail
+    {
+        bool pathMatches(const VpkReadOnly& vpk, uint32_t pathOffset, uint32_t pathSize, std::string_view path)
+        {
+            if (pathSize != path.size())
+                return false;
+            if (vpk.header.flags & kVpkFlagFrontCodedPaths)
+            {
+                thread_local std::string scratch;
+                return decodeFrontCodedPath(vpk, pathOffset, scratch) && scratch == path;
+            }
+            return uint64_t {pathOffset} + pathSize <= vpk.stringTable.size() &&
+                   vpk.stringTable.substr(pathOffset, pathSize) == path;
+        }
+    } // namespace detail
+
+    const VpkEntry* findVpkEntry(const VpkReadOnly& vpk, vbase::StringView logicalPath)
+    {
+        const VpkEntry* e = findVpkEntryOrTombstone(vpk, logicalPath);
+        return e && !(e->flags & kVpkEntryFlagTombstone) ? e : nullptr;
+    }
+
+    const VpkEntry* findVpkEntryOrTombstone(const VpkReadOnly& vpk, vbase::StringView logicalPath)
+    {
+        if (!logicalPath.empty() && logicalPath.front() == '/')
+            logicalPath.remove_prefix(1);
+
+        const std::string_view path(logicalPath.data(), logicalPath.size());
+
+        const uint64_t hash = hash64(path);
+        auto           it   = std::lower_bound(vpk.entries.begin(),
+                                       vpk.entries.end(),
+                                       hash,
+                                       [](const VpkEntry& e, uint64_t h) { return e.pathHash64 < h; });
+
+        for (; it != vpk.entries.end() && it->pathHash64 == hash; ++it)
+        {
+            if (detail::pathMatches(vpk, it->pathOffset, it->pathSize, path))
+                return &*it;
+        }
+
+        return nullptr;
+    }
+
+    namespace
+    {
+        // The order of the UUID index: UUIDs compared as raw bytes.
+        bool uuidLess(const vbase::UUID& a, const vbase::UUID& b)
+        {
+            return std::memcmp(&a, &b, sizeof(vbase::UUID)) < 0;
+        }
+
+        const VpkUuidIndexEntry* findUuidRow(const VpkReadOnly& vpk, const vbase::UUID& uuid)
+        {
+            const auto it = std::lower_bound(vpk.uuidIndex.begin(),
+                                             vpk.uuidIndex.end(),
+                                             uuid,
+                                             [](const VpkUuidIndexEntry& row, const vbase::UUID& u) {
+                                                 return uuidLess(row.uuid, u);
+                                             });
+            return it != vpk.uuidIndex.end() && it->uuid == uuid ? &*it : nullptr;
+        }
+    } // namespace
+
+    uint32_t findVpkRegistryIndex(const VpkReadOnly& vpk, const vbase::UUID& uuid)
+    {
+        if (!vpk.uuidIndex.empty())
+        {
+            const VpkUuidIndexEntry* row = findUuidRow(vpk, uuid);
+            return row ? row->registry : UINT32_MAX;
+        }
+
+        for (size_t i = 0; i < vpk.registry.size(); ++i)
+            if (vpk.registry[i].uuid == uuid)
+                return static_cast<uint32_t>(i);
+        return UINT32_MAX;
+    }
+
+    const VpkEntry* findVpkEntryByUuid(const VpkReadOnly& vpk, const vbase::UUID& uuid)
+    {
+        if (!vpk.uuidIndex.empty())
+        {
+            const VpkUuidIndexEntry* row = findUuidRow(vpk, uuid);
+            return row ? &vpk.entries[row->entry] : nullptr;
+        }
+
+        const uint32_t index = findVpkRegistryIndex(vpk, uuid);
+        if (index == UINT32_MAX)
+            return nullptr;
+
+        std::string            scratch;
+        const std::string_view path = vpkPathOf(vpk, vpk.registry[index], scratch);
+        return path.empty() ? nullptr : findVpkEntry(vpk, path);
+    }
+
+    namespace
+    {
+        // Split a directory path into its non-empty components.
+        template<typename Fn>
+        bool forEachComponent(std::string_view path, Fn&& fn)
+        {
+            size_t begin = 0;
+            while (begin <= path.size())
+            {
+                size_t end = path.find('/', begin);
+                if (end == std::string_view::npos)
+                    end = path.size();
+                if (end > begin && !fn(path.substr(begin, end - begin)))
+                    return false;
+                begin = end + 1;
+            }
+            return true;
+        }
+
+        // An entry's path as a view that lives as long as the package, for listings.
+        std::string_view entryPath(const VpkReadOnly& vpk, const VpkEntry& e)
+        {
+            if (vpk.pathNames)
+                return vpk.pathNames->path(vpk, e.pathOffset, e.pathSize);
+            if (uint64_t {e.pathOffset} + e.pathSize > vpk.stringTable.size())
+                return {};
+            return vpk.stringTable.substr(e.pathOffset, e.pathSize);
+        }
+
+        std::string_view nodeName(const VpkReadOnly& vpk, const VpkDirectoryNode& node)
+        {
+            if (uint64_t {node.nameOffset} + node.nameSize > vpk.stringTable.size())
+                return {};
+            return vpk.stringTable.substr(node.nameOffset, node.nameSize);
+        }
+
+        // Walk the directory table one component at a time (binary search among each node's
+        // name-sorted subdirectories).
+        const VpkDirectoryNode* findDirectoryNode(const VpkReadOnly& vpk, std::string_view dirPath)
+        {
+            if (vpk.directories.empty())
+                return nullptr;
+
+            const VpkDirectoryNode* node = &vpk.directories[0];
+            const bool              found = forEachComponent(dirPath, [&](std::string_view name) {
+                if (uint64_t {node->firstDir} + node->dirCount > vpk.directories.size())
+                    return false;
+
+                const auto children = vpk.directories.subspan(node->firstDir, node->dirCount);
+                auto       it       = std::lower_bound(
+                    children.begin(), children.end(), name, [&](const VpkDirectoryNode& n, std::string_view key) {
+                        return nodeName(vpk, n) < key;
+                    });
+                if (it == children.end() || nodeName(vpk, *it) != name)
+                    return false;
+                node = &*it;
+                return true;
+            });
+            return found ? node : nullptr;
+        }
+
+        // Normalized "a/b/" prefix for the index scan used by packs without a directory table.
+        std::string directoryPrefix(std::string_view dirPath)
+        {
+            std::string prefix;
+            forEachComponent(dirPath, [&](std::string_view name) {
+                prefix.append(name).push_back('/');
+                return true;
+            });
+            return prefix;
+        }
+    } // namespace
+
+    bool isVpkDirectory(const VpkReadOnly& vpk, vbase::StringView dirPath)
+    {
+        const std::string_view path(dirPath.data(), dirPath.size());
+        if (!vpk.directories.empty())
+            return findDirectoryNode(vpk, path) != nullptr;
+
+        const std::string prefix = directoryPrefix(path);
+        if (prefix.empty())
+            return true;
+        std::string scratch;
+        return std::any_of(vpk.entries.begin(), vpk.entries.end(), [&](const VpkEntry& e) {
+            return !(e.flags & kVpkEntryFlagTombstone) && vpkPathOf(vpk, e, scratch).starts_with(prefix);
+        });
+    }
+
+    vbase::Result<std::vector<VpkListEntry>, AssetError> listVpkDirectory(const VpkReadOnly& vpk,
+                                                                          vbase::StringView  dirPath)
+    {
+        const std::string_view    path(dirPath.data(), dirPath.size());
+        std::vector<VpkListEntry> out;
+
+        auto fileName = [](std::string_view p) {
+            const size_t slash = p.rfind('/');
+            return slash == std::string_view::npos ? p : p.substr(slash + 1);
+        };
+
+        if (!vpk.directories.empty())
+        {
+            const VpkDirectoryNode* node = findDirectoryNode(vpk, path);
+            if (!node || uint64_t {node->firstDir} + node->dirCount > vpk.directories.size() ||
+                uint64_t {node->firstFile} + node->fileCount > vpk.directoryFiles.size())
+                return vbase::Result<std::vector<VpkListEntry>, AssetError>::err(AssetError::eNotFound);
+
+            out.reserve(node->dirCount + node->fileCount);
+            for (const auto& child : vpk.directories.subspan(node->firstDir, node->dirCount))
+                out.push_back({nodeName(vpk, child), true, nullptr});
+            for (uint32_t index : vpk.directoryFiles.subspan(node->firstFile, node->fileCount))
+            {
+                if (index >= vpk.entries.size())
+                    return vbase::Result<std::vector<VpkListEntry>, AssetError>::err(AssetError::eInvalidFormat);
+                const VpkEntry& e = vpk.entries[index];
+                out.push_back({fileName(entryPath(vpk, e)), false, &e});
+            }
+            return vbase::Result<std::vector<VpkListEntry>, AssetError>::ok(std::move(out));
+        }
+
+        // No directory table: scan the whole index.
+        const std::string                prefix = directoryPrefix(path);
+        std::map<std::string_view, bool> dirs;
+        std::vector<VpkListEntry>        files;
+        for (const auto& e : vpk.entries)
+        {
+            std::string_view rest = entryPath(vpk, e);
+            if ((e.flags & kVpkEntryFlagTombstone) || !rest.starts_with(prefix))
+                continue;
+            rest.remove_prefix(prefix.size());
+
+            const size_t slash = rest.find('/');
+            if (slash == std::string_view::npos)
+                files.push_back({rest, false, &e});
+            else if (slash > 0)
+                dirs.emplace(rest.substr(0, slash), true);
+        }
+        if (!prefix.empty() && dirs.empty() && files.empty())
+            return vbase::Result<std::vector<VpkListEntry>, AssetError>::err(AssetError::eNotFound);
+
+        std::stable_sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+        for (const auto& dir : dirs)
+            out.push_back({dir.first, true, nullptr});
+        out.insert(out.end(), files.begin(), files.end());
+        return vbase::Result<std::vector<VpkListEntry>, AssetError>::ok(std::move(out));
+    }
+
+    vbase::Result<VpkFileStat, AssetError> statVpkFile(const VpkReadOnly& vpk, vbase::StringView logicalPath)
+    {
+        const VpkEntry* e = findVpkEntry(vpk, logicalPath);
+        if (!e)
+            return vbase::Result<VpkFileStat, AssetError>::err(AssetError::eNotFound);
+        return vbase::Result<VpkFileStat, AssetError>::ok(detail::entryStat(*e));
+    }
+
+    namespace detail
+    {
+        VpkFileStat entryStat(const VpkEntry& e)
+        {
+            VpkFileStat st {};
+            st.rawSize     = e.rawSize;
+            st.packedSize  = e.packedSize;
+            st.compression = e.compression;
+            return st;
+        }
+
+        vbase::Result<void, AssetError> readEntryInto(const VpkReadOnly&      vpk,
+                                                      vbase::StringView       vpkPath,
+                                                      const VpkEntry&         e,
+                                                      std::vector<std::byte>& out)
+        {
+            // Stored entries are read straight into `out`; compressed ones through a pooled packed buffer.
+            if (e.compression == VpkCompression::eNone)
+            {
+                out.resize(static_cast<size_t>(e.packedSize));
+                if (!readPacked(vpk, vpkPath, e, out.data()))
+                    return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+                if (vpk.verifyOnRead && !entryChecksumMatches(vpk, e, out))
+                    return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+                return vbase::Result<void, AssetError>::ok();
+            }
+
+            ScratchBuffer packed(static_cast<size_t>(e.packedSize));
+            if (!readPacked(vpk, vpkPath, e, packed.data()))
+                return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+
+            return unpackEntryInto(vpk, e, packed.span(), out);
+        }
+
+        vbase::Result<void, AssetError> readEntryFromMemoryInto(const VpkReadOnly&      vpk,
+                                                                const VpkEntry&         e,
+                                                                vbase::ConstByteSpan    blob,
+                                                                std::vector<std::byte>& out)
+        {
+            // The payloads of a multi-volume pack are not in its image, and a pack opened from memory
+            // has no volumes to read them from.
+            if (vpk.header.flags & kVpkFlagVolumes)
+            {
+                if (!vpk.volumes)
+                    return vbase::Result<void, AssetError>::err(AssetError::eNotSupported);
+                return readEntryInto(vpk, {}, e, out);
+            }
+
+            if (e.dataOffset > blob.size() || e.packedSize > blob.size() - e.dataOffset)
+                return vbase::Result<void, AssetError>::err(AssetError::eInvalidFormat);
+
+            return unpackEntryInto(
+                vpk, e, blob.subspan(static_cast<size_t>(e.dataOffset), static_cast<size_t>(e.packedSize)), out);
+        }
+
+        vbase::Result<std::vector<std::byte>, AssetError>
+        readEntry(const VpkReadOnly& vpk, vbase::StringView vpkPath, const VpkEntry& e)
+        {
+            std::vector<std::byte> raw;
+            if (auto r = readEntryInto(vpk, vpkPath, e, raw); !r)
+                return vbase::Result<std::vector<std::byte>, AssetError>::err(r.error());
+            return vbase::Result<std::vector<std::byte>, AssetError>::ok(std::move(raw));
+        }
+
+        vbase::Result<std::vector<std::byte>, AssetError>
+        readEntryFromMemory(const VpkReadOnly& vpk, const VpkEntry& e, vbase::ConstByteSpan blob)
+        {
+            std::vector<std::byte> raw;
+            if (auto r = readEntryFromMemoryInto(vpk, e, blob, raw); !r)
+                return vbase::Result<std::vector<std::byte>, AssetError>::err(r.error());
+            return vbase::Result<std::vector<std::byte>, AssetError>::ok(std::move(raw));
+        }
+    } // namespace detail
+
+    vbase::Result<std::vector<std::byte>, AssetError>
+    readVpkFile(const VpkReadOnly& vpk, vbase::StringView vpkPath, vbase::StringView logicalPath)
+    {
+        const VpkEntry* e = findVpkEntry(vpk, logicalPath);
+        if (!e)
+            return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eNotFound);
+
+        return detail::readEntry(vpk, vpkPath, *e);
+    }
+
+    vbase::Result<std::vector<std::byte>, AssetError>
+    readVpkFileFromMemory(const VpkReadOnly& vpk, vbase::ConstByteSpan blob, vbase::StringView logicalPath)
+    {
+        const VpkEntry* e = findVpkEntry(vpk, logicalPath);
+        if (!e)
+            return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eNotFound);
+
+        return detail::readEntryFromMemory(vpk, *e, blob);
+    }
+
+    vbase::Result<void, AssetError> readVpkFileInto(const VpkReadOnly&      vpk,
+                                                    vbase::StringView       vpkPath,
+                                                    vbase::StringView       logicalPath,
+                                                    std::vector<std::byte>& out)
+    {
+        const VpkEntry* e = findVpkEntry(vpk, logicalPath);
+        if (!e)
+            return vbase::Result<void, AssetError>::err(AssetError::eNotFound);
+
+        return detail::readEntryInto(vpk, vpkPath, *e, out);
+    }
+
+    vbase::Result<void, AssetError> readVpkFileFromMemoryInto(const VpkReadOnly&      vpk,
+                                                              vbase::ConstByteSpan    blob,
+                                                              vbase::StringView       logicalPath,
+                                                              std::vector<std::byte>& out)
+    {
+        const VpkEntry* e = findVpkEntry(vpk, logicalPath);
+        if (!e)
+            return vbase::Result<void, AssetError>::err(AssetError::eNotFound);
+
+        return detail::readEntryFromMemoryInto(vpk, *e, blob, out);
+    }
+
+    vbase::Result<std::vector<std::byte>, AssetError>
+    readVpkFileByUuid(const VpkReadOnly& vpk, vbase::StringView vpkPath, const vbase::UUID& uuid)
+    {
+        const VpkEntry* e = findVpkEntryByUuid(vpk, uuid);
+        if (!e)
+            return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eNotFound);
+
+        return detail::readEntry(vpk, vpkPath, *e);
+    }
+
+    vbase::Result<std::vector<std::byte>, AssetError>
+    readVpkFileFromMemoryByUuid(const VpkReadOnly& vpk, vbase::ConstByteSpan blob, const vbase::UUID& uuid)
+    {
+        const VpkEntry* e = findVpkEntryByUuid(vpk, uuid);
+        if (!e)
+            return vbase::Result<std::vector<std::byte>, AssetError>::err(AssetError::eNotFound);
+
+        return detail::readEntryFromMemory(vpk, *e, blob);
+    }
+
+    std::vector<uint32_t> collectVpkDependencies(const VpkReadOnly& vpk, const vbase::UUID& root, uint32_t depth)
+    {
+        std::vector<uint32_t> out;
+        if (const uint32_t index = findVpkRegistryIndex(vpk, root); index != UINT32_MAX)
+            out.push_back(index);
+        if (out.empty() || vpk.dependencies.empty())
+            return out;
+
+        // Breadth-first: out[levelBegin, levelEnd) is the current hop.
+        std::vector<bool> seen(vpk.registry.size(), false);
+        seen[out.front()] = true;
+        size_t levelBegin = 0;
+        for (uint32_t hop = 0; hop < depth && levelBegin < out.size(); ++hop)
+        {
+            const size_t levelEnd = out.size();
+            for (size_t k = levelBegin; k < levelEnd; ++k)
+            {
+                const VpkDependencyRange range = vpk.dependencies[out[k]];
+                for (const uint32_t target : vpk.dependencyTargets.subspan(range.first, range.count))
+                {
+                    if (!seen[target])
+                    {
+                        seen[target] = true;
+                        out.push_back(target);
+                    }
+                }
+            }
+            levelBegin = levelEnd;
+        }
+        return out;
+    }
+
+    VpkVerifyReport verifyVpk(const VpkReadOnly& vpk, vbase::StringView vpkPath, uint32_t threads)
+    {
+        // Checksums are compared below rather than through verifyOnRead, so entries of packs without
+        // them are still decoded. Workers share one handle.
+        VpkReadOnly source  = vpk;
+        source.verifyOnRead = false;
+        if (!source.file)
+        {
+            if (auto opened = VpkFileHandle::open(vpkPath))
+                source.file = std::move(opened).value();
+        }
+        if ((source.header.flags & kVpkFlagVolumes) && !source.volumes)
+            source.volumes = std::make_shared<VpkVolumes>(std::string(vpkPath), source.volumeSizes);
+
+        // Payloads in file order. Deduplicated entries point at their first copy and share its payload.
+        std::vector<size_t> order;
+        order.reserve(vpk.entries.size());
+        for (size_t i = 0; i < vpk.entries.size(); ++i)
+            if ((vpk.entries[i].flags & kVpkEntryFlagTombstone) == 0)
+                order.push_back(i);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return payloadBefore(vpk.entries[a], vpk.entries[b]);
+        });
+
+        auto sharesPayload = [](const VpkEntry& a, const VpkEntry& b) {
+            return a.packedSize > 0 && a.volume == b.volume && a.dataOffset == b.dataOffset &&
+                   a.packedSize == b.packedSize &&
+                   a.rawSize == b.rawSize && a.compression == b.compression && a.dictionary == b.dictionary;
+        };
+
+        std::vector<size_t> payloads; // index of the entry each payload is decoded through
+        std::vector<size_t> payloadOf(vpk.entries.size(), 0);
+        for (size_t i : order)
+        {
+            if (payloads.empty() || !sharesPayload(vpk.entries[i], vpk.entries[payloads.back()]))
+                payloads.push_back(i);
+            payloadOf[i] = payloads.size() - 1;
+        }
+
+        // Each worker decodes one contiguous range, so reads stay sequential per thread.
+        std::vector<uint8_t>  decoded(payloads.size(), 0);
+        std::vector<uint64_t> hashes(payloads.size(), 0);
+        const uint32_t        workers = resolveThreadCount(threads, payloads.size());
+        const size_t          chunk   = workers > 0 ? (payloads.size() + workers - 1) / workers : 0;
+        runJobs(workers, workers, [&](size_t w) {
+            std::vector<std::byte> raw;
+            for (size_t p = w * chunk; p < std::min(payloads.size(), (w + 1) * chunk); ++p)
+            {
+                if (!detail::readEntryInto(source, vpkPath, source.entries[payloads[p]], raw))
+                    continue;
+                decoded[p] = 1;
+                hashes[p]  = XXH3_64bits(raw.data(), raw.size());
+            }
+        });
+
+        VpkVerifyReport report;
+        std::string     scratch;
+        for (size_t i = 0; i < vpk.entries.size(); ++i)
+        {
+            const VpkEntry& e = vpk.entries[i];
+            if (e.flags & kVpkEntryFlagTombstone)
+                continue;
+
+            const size_t p = payloadOf[i];
+            if (decoded[p] && vpk.checksums.empty())
+                ++report.unverified;
+            else if (decoded[p] && hashes[p] == vpk.checksums[i])
+                ++report.checked;
+            else
+                report.corrupt.emplace_back(vpkPathOf(vpk, e, scratch));
+        }
+        return report;
+    }
+
+    namespace
+    {
+        // Resolve every path up front; missing paths are marked eNotFound in `out`.
+        std::vector<const VpkEntry*> resolveBatch(const VpkReadOnly&                 vpk,
+                                                  std::span<const vbase::StringView> logicalPaths,
+                                                  std::vector<VpkBatchRead>&         out)
+        {
+            std::vector<const VpkEntry*> entries(logicalPaths.size(), nullptr);
+            out.resize(logicalPaths.size());
+            for (size_t i = 0; i < logicalPaths.size(); ++i)
+            {
+                entries[i] = findVpkEntry(vpk, logicalPaths[i]);
+                if (!entries[i])
+                    out[i].error = AssetError::eNotFound;
+            }
+            return entries;
+        }
+
+        void storeBatchResult(VpkBatchRead& out, vbase::Result<std::vector<std::byte>, AssetError> r)
+        {
+            if (r)
+                out.bytes = std::move(r.value());
+            else
+                out.error = r.error();
+        }
+    } // namespace
+
+    std::vector<VpkBatchRead> readVpkFiles(const VpkReadOnly&                 vpk,
+                                           vbase::StringView                  vpkPath,
+                                           std::span<const vbase::StringView> logicalPaths,
+                                           const VpkBatchReadOptions&         options)
+    {
+        std::vector<VpkBatchRead>    out;
+        std::vector<const VpkEntry*> entries = resolveBatch(vpk, logicalPaths, out);
+
+        // One handle (per volume) for the whole batch, even for a VpkReadOnly that was not opened with one.
+        const bool                           multiVolume = (vpk.header.flags & kVpkFlagVolumes) != 0;
+        std::shared_ptr<const VpkVolumes>    volumes     = vpk.volumes;
+        std::shared_ptr<const VpkFileHandle> file        = vpk.file;
+        if (multiVolume && !volumes)
+            volumes = std::make_shared<VpkVolumes>(std::string(vpkPath), vpk.volumeSizes);
+        if (!multiVolume && !file)
+        {
+            auto opened = VpkFileHandle::open(vpkPath);
+            if (!opened)
+            {
+                for (size_t i = 0; i < out.size(); ++i)
+                    if (entries[i])
+                        out[i].error = opened.error();
+                return out;
+            }
+            file = std::move(opened).value();
+        }
+
+        // Order requests by file offset, then cut them into runs that are read with one call each.
+        // Runs never cross a volume boundary.
+        std::vector<size_t> order;
+        order.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+            if (entries[i])
+                order.push_back(i);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return payloadBefore(*entries[a], *entries[b]);
+        });
+
+        struct Run
+        {
+            uint64_t begin {0};
+            uint64_t end {0};
+            size_t   first {0}; // range in `order`
+            size_t   count {0};
+            uint32_t volume {0};
+        };
+        std::vector<Run> runs;
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            const VpkEntry& e   = *entries[order[k]];
+            const uint64_t  end = e.dataOffset + e.packedSize;
+            if (!runs.empty())
+            {
+                Run& run = runs.back();
+                if (e.volume == run.volume && e.dataOffset <= run.end + options.maxGap &&
+                    std::max(end, run.end) - run.begin <= options.maxSpan)
+                {
+                    run.end = std::max(run.end, end);
+                    ++run.count;
+                    continue;
+                }
+            }
+            runs.push_back({e.dataOffset, end, k, 1, e.volume});
+        }
+
+        runJobs(runs.size(), resolveThreadCount(options.threads, runs.size()), [&](size_t r) {
+            const Run&            run    = runs[r];
+            const auto            source = volumes ? volumes->handle(run.volume) : file;
+            detail::ScratchBuffer buffer(static_cast<size_t>(run.end - run.begin));
+            const bool ok = buffer.size() == 0 || (source && source->readAt(run.begin, buffer.data(), buffer.size()));
+
+            for (size_t k = run.first; k < run.first + run.count; ++k)
+            {
+                const size_t    i = order[k];
+                const VpkEntry& e = *entries[i];
+                if (!ok)
+                {
+                    out[i].error = AssetError::eIOError;
+                    continue;
+                }
+                const auto packed = buffer.span().subspan(static_cast<size_t>(e.dataOffset - run.begin),
+                                                          static_cast<size_t>(e.packedSize));
+                storeBatchResult(out[i], unpackEntry(vpk, e, packed));
+            }
+        });
+
+        return out;
+    }
+
+    std::vector<VpkBatchRead> readVpkFilesFromMemory(const VpkReadOnly&                 vpk,
+                                                     vbase::ConstByteSpan               blob,
+                                                     std::span<const vbase::StringView> logicalPaths,
+                                                     const VpkBatchReadOptions&         options)
+    {
+        std::vector<VpkBatchRead>    out;
+        std::vector<const VpkEntry*> entries = resolveBatch(vpk, logicalPaths, out);
+
+        runJobs(entries.size(), resolveThreadCount(options.threads, entries.size()), [&](size_t i) {
+            if (entries[i])
+                storeBatchResult(out[i], detail::readEntryFromMemory(vpk, *entries[i], blob));
+        });
+
+        return out;
+    }
+
+    vbase::Result<vbase::ConstByteSpan, AssetError>
+    viewVpkFileFromMemory(const VpkReadOnly& vpk, vbase::ConstByteSpan blob, vbase::StringView logicalPath)
+    {
+        const VpkEntry* e = findVpkEntry(vpk, logicalPath);
+        if (!e)
+            return vbase::Result<vbase::ConstByteSpan, AssetError>::err(AssetError::eNotFound);
+
+        return detail::viewEntryFromMemory(vpk, *e, blob);
+    }
+
+    namespace detail
+    {
+        vbase::Result<vbase::ConstByteSpan, AssetError>
+        viewEntryFromMemory(const VpkReadOnly& vpk, const VpkEntry& e, vbase::ConstByteSpan blob)
+        {
+            if (e.compression != VpkCompression::eNone || (vpk.header.flags & kVpkFlagVolumes))
+                return vbase::Result<vbase::ConstByteSpan, AssetError>::err(AssetError::eNotSupported);
+
+            if (e.dataOffset > blob.size() || e.packedSize > blob.size() - e.dataOffset)
+                return vbase::Result<vbase::ConstByteSpan, AssetError>::err(AssetError::eInvalidFormat);
+
+            return vbase::Result<vbase::ConstByteSpan, AssetError>::ok(
+                blob.subspan(static_cast<size_t>(e.dataOffset), static_cast<size_t>(e.packedSize)));
+        }
+    } // namespace detail
+
+    // LZ4-compress `src` into `dst` as one block: the fast compressor at level 0, LZ4HC above.
+    static bool compressLz4(int level, std::vector<std::byte>& dst, vbase::ConstByteSpan src)
+    {
+        const int srcSize = static_cast<int>(src.size());
+        dst.resize(static_cast<size_t>(LZ4_compressBound(srcSize)));
+
+        const char* in  = reinterpret_cast<const char*>(src.data());
+        char*       out = reinterpret_cast<char*>(dst.data());
+        const int   n   = level > 0 ? LZ4_compress_HC(in, out, srcSize, static_cast<int>(dst.size()), level) :
+                                      LZ4_compress_default(in, out, srcSize, static_cast<int>(dst.size()));
+        if (n <= 0)
+            return false;
+        dst.resize(static_cast<size_t>(n));
+        return true;
+    }
+
+    // Compress `src` into `dst` (sized to its compress bound) without a dictionary.
+    static size_t compressPlain(ZSTD_CCtx* cctx, int level, std::vector<std::byte>& dst, vbase::ConstByteSpan src)
+    {
+        ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+        return ZSTD_compressCCtx(cctx, dst.data(), dst.size(), src.data(), src.size(), level);
+    }
+
+    // Compress `src` against `cdict`. The entry names its dictionary, so the 4-byte dictionary ID in
+    // the frame header is dropped.
+    static size_t compressWithDictionary(ZSTD_CCtx*              cctx,
+                                         const ZSTD_CDict*       cdict,
+                                         int                     level,
+                                         std::vector<std::byte>& dst,
+                                         vbase::ConstByteSpan    src)
+    {
+        ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_dictIDFlag, 0);
+        ZSTD_CCtx_refCDict(cctx, cdict);
+        return ZSTD_compress2(cctx, dst.data(), dst.size(), src.data(), src.size());
+    }
+
+    // Write-side state of a VpkWriter. Entries queue in add() order, are packed a window at a time (in
+    // parallel) and are appended in that same order, so the output does not depend on the thread count.
+    //
+    // Small compressible entries are dictionary candidates: their type's dictionary is trained from the
+    // first candidates seen, up to a sample budget. Candidates queued before that decision hold back
+    // the queue, so the decision is forced once a full window is waiting behind one.
+    class VpkWriterState final
+    {
+    public:
+        vbase::Result<void, AssetError> open(vbase::StringView outPath, const VpkWriteOptions& options);
+        vbase::Result<void, AssetError> add(const VpkWriteItem* borrowed, VpkWriteItem owned);
+        vbase::Result<void, AssetError> addTombstone(vbase::StringView logicalPath);
+        vbase::Result<void, AssetError> finish();
+
+        size_t   entryCount() const { return m_Entries.size() + m_Pending.size(); }
+        uint64_t bytesWritten() const { return m_Offset + m_VolumeBytes + m_VolumeOffset; }
+
+        VpkWriteStats stats() const
+        {
+            VpkWriteStats out = m_Stats;
+            out.entries       = m_Entries.size();
+            return out;
+        }
+
+    private:
+        static constexpr size_t   kWindowItemsPerThread = 4;
+        static constexpr uint64_t kWindowBytes          = 256ull << 20;
+        static constexpr size_t   kMinSamples           = 8;
+        static constexpr size_t   kMinDictionarySize    = 256;
+        static constexpr uint64_t kSamplesPerDictByte   = 100; // ZDICT wants roughly 10-100x
+
+        using CCtxPtr  = std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>;
+        using CDictPtr = std::unique_ptr<ZSTD_CDict, decltype(&ZSTD_freeCDict)>;
+
+        struct Pending
+        {
+            VpkWriteItem        owned;
+            const VpkWriteItem* item {nullptr}; // &owned, or the caller's item (writeVpk)
+            bool                candidate {false};
+            bool                tombstone {false};
+            bool                duplicate {false}; // payload matches an earlier entry's
+            XXH128_hash_t       hash {};
+            uint64_t            checksum {0}; // XXH3-64 of the raw bytes, when the pack records checksums
+
+            VpkCompression         compression {VpkCompression::eNone};
+            uint8_t                dictionary {0};
+            std::vector<std::byte> packed; // empty when stored
+        };
+
+        // Identifies a payload by content. rawSize is included so a hash collision would also need
+        // equal lengths. Entries only share a payload when it also meets their alignment and they
+        // would be encoded alike (a stored entry must stay stored, so it can still be borrowed).
+        struct PayloadKey
+        {
+            uint64_t low {0};
+            uint64_t high {0};
+            uint64_t rawSize {0};
+            uint32_t alignment {0};
+            bool     compress {false};
+
+            bool operator==(const PayloadKey&) const = default;
+        };
+
+        struct PayloadKeyHash
+        {
+            size_t operator()(const PayloadKey& k) const { return static_cast<size_t>(k.low); }
+        };
+
+        PayloadKey payloadKey(const Pending& p) const
+        {
+            return {p.hash.low64,
+                    p.hash.high64,
+                    static_cast<uint64_t>(p.item->bytes.size()),
+                    payloadAlignment(p.item->type),
+                    should_compress(*p.item)};
+        }
+
+        struct TypeDictionary
+        {
+            bool                   decided {false};
+            uint8_t                index {0}; // 1-based dictionary number; 0 = none
+            std::vector<std::byte> samples;
+            std::vector<size_t>    sampleSizes;
+            CDictPtr               cdict {nullptr, &ZSTD_freeCDict};
+        };
+
+        bool isReady(const Pending& p) const { return !p.candidate || m_Types.at(p.item->type).decided; }
+        bool decide(VAssetType type);
+        void findDuplicates(size_t ready);
+        bool pack(Pending& p) const;
+        bool packZstd(Pending& p) const;
+        void append(const Pending& p);
+
+        uint32_t payloadAlignment(VAssetType type) const;
+        void     padTo(std::ofstream& out, uint64_t& offset, uint64_t alignment);
+        void     alignTables();
+
+        // The volume the next payload goes to: the open one while the payload still fits, otherwise a
+        // new one. A payload larger than volumeSize gets a volume to itself.
+        std::ofstream& volumeFor(uint64_t size, uint64_t alignment);
+        void           closeVolume();
+
+        // Move the paths into front-coded buckets and leave only directory names in the string table.
+        void frontCodePaths(std::vector<VpkDirectoryNode>& directories,
+                            std::vector<uint32_t>&         pathBuckets,
+                            std::string&                   pathData);
+
+        vbase::Result<void, AssetError> pump(bool final);
+
+        std::ofstream   m_File;
+        std::string     m_Path;
+        VpkWriteOptions m_Options;
+        uint32_t        m_Threads {1};
+        VpkHeader       m_Header {};
+        uint64_t        m_Offset {0};
+
+        // Multi-volume output (volumeSize > 0): the open volume is number m_VolumeSizes.size().
+        std::ofstream         m_Volume;
+        uint64_t              m_VolumeOffset {0};
+        uint64_t              m_VolumeBytes {0}; // sum of m_VolumeSizes
+        std::vector<uint64_t> m_VolumeSizes;     // closed volumes
+        bool                  m_VolumeFailed {false};
+
+        std::string                        m_StringTable;
+        std::vector<VpkEntry>              m_Entries;
+        std::vector<uint64_t>              m_Checksums; // parallel to m_Entries
+        std::vector<VpkAssetRegistryEntry> m_Registry;
+        std::vector<std::vector<vbase::UUID>> m_Dependencies; // parallel to m_Registry
+
+        std::deque<Pending> m_Pending;
+        uint64_t            m_PendingBytes {0};
+
+        std::map<VAssetType, TypeDictionary> m_Types;
+        std::vector<VpkDictionaryEntry>      m_DictionaryEntries; // offsets are assigned by finish()
+        std::vector<std::vector<std::byte>>  m_DictionaryBodies;
+
+        std::unordered_map<PayloadKey, size_t, PayloadKeyHash> m_Payloads; // -> m_Entries index of the first copy
+        VpkWriteStats                                          m_Stats;
+    };
+
+    vbase::Result<void, AssetError> VpkWriterState::open(vbase::StringView outPath, const VpkWriteOptions& options)
+    {
+        // Alignments must be powers of two (their log2 always fits the header field).
+        if (!std::has_single_bit(options.payloadAlignment) ||
+            !std::all_of(options.typeAlignment.begin(), options.typeAlignment.end(), [](const auto& t) {
+                return std::has_single_bit(t.second);
+            }))
+            return vbase::Result<void, AssetError>::err(AssetError::eNotSupported);
+
+        std::filesystem::path p(outPath);
+        if (p.has_parent_path())
+            std::filesystem::create_directories(p.parent_path());
+
+        m_File.open(std::string(outPath), std::ios::binary | std::ios::trunc);
+        if (!m_File)
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+
+        m_Path    = std::string(outPath);
+        m_Options = options;
+        m_Threads = resolveThreadCount(options.threads, SIZE_MAX);
+
+        // Header placeholder, patched by finish().
+        std::memcpy(m_Header.magic, "VPK\0", 4);
+        const auto alignmentLog2 = static_cast<uint32_t>(std::countr_zero(options.payloadAlignment));
+        m_Header.version         = VPK_VERSION;
+        m_Header.flags           = kVpkFlagSortedIndex | (options.patch ? kVpkFlagPatch : 0u) |
+                         (options.frontCodedPaths ? kVpkFlagFrontCodedPaths : 0u) |
+                         (options.volumeSize > 0 ? kVpkFlagVolumes : 0u) | (alignmentLog2 << kVpkFlagAlignmentShift);
+        m_Header.dataOffset      = sizeof(m_Header);
+        m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+        m_Offset = m_Header.dataOffset;
+
+        return vbase::Result<void, AssetError>::ok();
+    }
+
+    vbase::Result<void, AssetError> VpkWriterState::add(const VpkWriteItem* borrowed, VpkWriteItem owned)
+    {
+        if (!m_File.is_open())
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+
+        Pending& p = m_Pending.emplace_back();
+        p.owned    = std::move(owned);
+        p.item     = borrowed ? borrowed : &p.owned;
+
+        const VpkWriteItem& it = *p.item;
+        m_PendingBytes += it.bytes.size();
+
+        p.candidate = m_Options.trainDictionaries && m_Options.codec != VpkCodec::eLz4 && should_compress(it) &&
+                      !should_frame(it, m_Options) && it.bytes.size() <= m_Options.dictionaryMaxEntrySize;
+        if (p.candidate)
+        {
+            TypeDictionary& t = m_Types[it.type];
+            if (!t.decided)
+            {
+                t.samples.insert(t.samples.end(), it.bytes.begin(), it.bytes.end());
+                t.sampleSizes.push_back(it.bytes.size());
+                if (t.samples.size() >= uint64_t {m_Options.dictionaryCapacity} * kSamplesPerDictByte &&
+                    !decide(it.type))
+                    return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+            }
+        }
+
+        return pump(false);
+    }
+
+    vbase::Result<void, AssetError> VpkWriterState::addTombstone(vbase::StringView logicalPath)
+    {
+        if (!m_File.is_open())
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+
+        Pending& p          = m_Pending.emplace_back();
+        p.owned.logicalPath = std::string(logicalPath);
+        p.item              = &p.owned;
+        p.tombstone         = true;
+        return pump(false);
+    }
+
+    // Train `type`'s dictionary from the samples collected so far. It is kept only when it shrinks them
+    // by more than its own size; a type with too few samples gets none.
+    bool VpkWriterState::decide(VAssetType type)
+    {
+        TypeDictionary& t = m_Types[type];
+        t.decided         = true;
+
+        const std::vector<std::byte> samples     = std::move(t.samples);
+        const std::vector<size_t>    sampleSizes = std::move(t.sampleSizes);
+        if (sampleSizes.size() < kMinSamples || m_DictionaryBodies.size() >= UINT8_MAX)
+            return true;
+
+        const size_t capacity = std::min<size_t>(m_Options.dictionaryCapacity, samples.size() / 8);
+        if (capacity < kMinDictionarySize)
+            return true;
+
+        std::vector<std::byte> dict(capacity);
+        const size_t           dictSize = ZDICT_trainFromBuffer(dict.data(),
+                                                      dict.size(),
+                                                      samples.data(),
+                                                      sampleSizes.data(),
+                                                      static_cast<unsigned>(sampleSizes.size()));
+        if (ZDICT_isError(dictSize))
+            return true;
+        dict.resize(dictSize);
+
+        CDictPtr cdict(ZSTD_createCDict(dict.data(), dict.size(), m_Options.zstdLevel), &ZSTD_freeCDict);
+        if (!cdict)
+            return false;
+
+        // Compress every sample both ways, one contiguous chunk of samples per worker.
+        std::vector<size_t> offsets(sampleSizes.size());
+        for (size_t s = 1; s < sampleSizes.size(); ++s)
+            offsets[s] = offsets[s - 1] + sampleSizes[s - 1];
+
+        std::vector<uint64_t> plainSizes(sampleSizes.size());
+        std::vector<uint64_t> bestSizes(sampleSizes.size());
+        std::atomic<bool>     failed {false};
+
+        const uint32_t threads = resolveThreadCount(m_Threads, sampleSizes.size());
+        const size_t   chunk   = (sampleSizes.size() + threads - 1) / threads;
+        runJobs(threads, threads, [&](size_t c) {
+            CCtxPtr cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+            if (!cctx)
+            {
+                failed = true;
+                return;
+            }
+
+            std::vector<std::byte> dst;
+            for (size_t s = c * chunk; s < std::min(sampleSizes.size(), (c + 1) * chunk); ++s)
+            {
+                const vbase::ConstByteSpan src {samples.data() + offsets[s], sampleSizes[s]};
+                dst.resize(ZSTD_compressBound(src.size()));
+
+                const size_t plain    = compressPlain(cctx.get(), m_Options.zstdLevel, dst, src);
+                const size_t withDict = compressWithDictionary(cctx.get(), cdict.get(), m_Options.zstdLevel, dst, src);
+                if (ZSTD_isError(plain) || ZSTD_isError(withDict))
+                {
+                    failed = true;
+                    return;
+                }
+                plainSizes[s] = plain;
+                bestSizes[s]  = std::min(plain, withDict);
+            }
+        });
+        if (failed)
+            return false;
+
+        uint64_t plainTotal = 0;
+        uint64_t bestTotal  = dict.size();
+        for (size_t s = 0; s < sampleSizes.size(); ++s)
+        {
+            plainTotal += plainSizes[s];
+            bestTotal += bestSizes[s];
+        }
+        if (bestTotal >= plainTotal)
+            return true;
+
+        VpkDictionaryEntry d {};
+        d.size = static_cast<uint64_t>(dict.size());
+        d.type = type;
+        m_DictionaryEntries.push_back(d);
+        m_DictionaryBodies.push_back(std::move(dict));
+
+        t.index = static_cast<uint8_t>(m_DictionaryBodies.size());
+        t.cdict = std::move(cdict);
+        return true;
+    }
+
+    // Hash the first `ready` queued payloads and flag those whose content was already appended or
+    // appears earlier in the window. Duplicates are neither compressed nor written; append() points
+    // them at the first copy, so the result does not depend on where window boundaries fall.
+    void VpkWriterState::findDuplicates(size_t ready)
+    {
+        runJobs(ready, resolveThreadCount(m_Threads, ready), [&](size_t k) {
+            Pending& p = m_Pending[k];
+            if (!p.tombstone && !p.item->bytes.empty())
+                p.hash = XXH3_128bits(p.item->bytes.data(), p.item->bytes.size());
+        });
+
+        std::unordered_set<PayloadKey, PayloadKeyHash> window;
+        for (size_t k = 0; k < ready; ++k)
+        {
+            Pending& p = m_Pending[k];
+            if (p.tombstone || p.item->bytes.empty())
+                continue;
+            const PayloadKey key = payloadKey(p);
+            p.duplicate          = m_Payloads.contains(key) || !window.insert(key).second;
+        }
+    }
+
+    // Pack one queued entry. Reads only shared state, so distinct entries pack concurrently.
+    bool VpkWriterState::pack(Pending& p) const
+    {
+        const VpkWriteItem&  it = *p.item;
+        vbase::ConstByteSpan bytes {it.bytes.data(), it.bytes.size()};
+
+        if (should_frame(it, m_Options))
+        {
+            p.compression = VpkCompression::eZstdFrames;
+            return packFrames(bytes, m_Options.zstdLevel, m_Options.frameSize, p.packed);
+        }
+        if (!should_compress(it))
+            return true;
+
+        // Entries beyond LZ4's input limit fall back to zstd.
+        const VpkCodec codec = bytes.size() <= LZ4_MAX_INPUT_SIZE ? m_Options.codec : VpkCodec::eZstd;
+        if (codec != VpkCodec::eLz4 && !packZstd(p))
+            return false;
+        if (codec == VpkCodec::eZstd)
+            return true;
+
+        std::vector<std::byte> lz4;
+        if (!compressLz4(m_Options.lz4Level, lz4, bytes))
+            return false;
+        if (codec == VpkCodec::eLz4)
+        {
+            p.compression = VpkCompression::eLz4;
+            p.packed      = std::move(lz4);
+            return true;
+        }
+
+        // Adaptive: keep whichever of zstd, LZ4 and the raw bytes is estimated to load fastest.
+        const VpkCodecCostModel& model = m_Options.costModel;
+        auto readTime = [&](size_t size) { return static_cast<double>(size) / model.readBytesPerSecond; };
+
+        const double raw      = static_cast<double>(bytes.size());
+        const double stored   = readTime(bytes.size());
+        const double zstdCost = readTime(p.packed.size()) + raw / model.zstdDecodeBytesPerSecond;
+        const double lz4Cost  = readTime(lz4.size()) + raw / model.lz4DecodeBytesPerSecond;
+
+        if (stored <= std::min(zstdCost, lz4Cost))
+        {
+            p.compression = VpkCompression::eNone;
+            p.dictionary  = 0;
+            p.packed.clear();
+        }
+        else if (lz4Cost < zstdCost)
+        {
+            p.compression = VpkCompression::eLz4;
+            p.dictionary  = 0;
+            p.packed      = std::move(lz4);
+        }
+        return true;
+    }
+
+    // zstd-compress one entry, against its type's dictionary when that comes out smaller.
+    bool VpkWriterState::packZstd(Pending& p) const
+    {
+        const VpkWriteItem&  it = *p.item;
+        vbase::ConstByteSpan bytes {it.bytes.data(), it.bytes.size()};
+
+        CCtxPtr cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+        if (!cctx)
+            return false;
+
+        p.compression = VpkCompression::eZstd;
+        p.packed.resize(ZSTD_compressBound(bytes.size()));
+        const size_t plainSize = compressPlain(cctx.get(), m_Options.zstdLevel, p.packed, bytes);
+        if (ZSTD_isError(plainSize))
+            return false;
+        p.packed.resize(plainSize);
+
+        // Candidates of a type that got a dictionary keep whichever encoding is smaller.
+        const TypeDictionary* dict = p.candidate ? &m_Types.at(it.type) : nullptr;
+        if (!dict || !dict->cdict)
+            return true;
+
+        std::vector<std::byte> withDict(ZSTD_compressBound(bytes.size()));
+        const size_t           dictSize =
+            compressWithDictionary(cctx.get(), dict->cdict.get(), m_Options.zstdLevel, withDict, bytes);
+        if (ZSTD_isError(dictSize))
+            return false;
+        if (dictSize < plainSize)
+        {
+            withDict.resize(dictSize);
+            p.packed     = std::move(withDict);
+            p.dictionary = dict->index;
+        }
+        return true;
+    }
+
+    void VpkWriterState::append(const Pending& p)
+    {
+        const VpkWriteItem& it = *p.item;
+
+        VpkEntry e {};
+        e.pathHash64 = hash64(it.logicalPath);
+
+        e.pathOffset = static_cast<uint32_t>(m_StringTable.size());
+        e.pathSize   = static_cast<uint32_t>(it.logicalPath.size());
+        m_StringTable.append(it.logicalPath.data(), it.logicalPath.size());
+        m_StringTable.push_back('\0');
+
+        if (p.tombstone)
+        {
+            e.flags      = kVpkEntryFlagTombstone;
+            e.dataOffset = m_Offset;
+            m_Entries.push_back(e);
+            m_Checksums.push_back(0);
+            return;
+        }
+
+        // Registry entry: UUID -> (string table path)
+        VpkAssetRegistryEntry r {};
+        r.uuid       = it.uuid;
+        r.pathOffset = e.pathOffset;
+        r.pathSize   = e.pathSize;
+        r.type       = it.type;
+        m_Registry.push_back(r);
+        m_Dependencies.push_back(it.dependencies);
+
+        if (p.duplicate)
+        {
+            const size_t   index = m_Payloads.at(payloadKey(p));
+            const VpkEntry first = m_Entries[index];
+            e.compression        = first.compression;
+            e.dictionary         = first.dictionary;
+            e.rawSize            = first.rawSize;
+            e.packedSize         = first.packedSize;
+            e.dataOffset         = first.dataOffset;
+            e.volume             = first.volume;
+            m_Entries.push_back(e);
+            m_Checksums.push_back(m_Checksums[index]);
+
+            ++m_Stats.dedupedEntries;
+            m_Stats.dedupedBytes += first.packedSize;
+            return;
+        }
+
+        if (p.compression == VpkCompression::eLz4)
+            ++m_Stats.lz4Entries;
+        else if (p.compression == VpkCompression::eNone)
+            ++m_Stats.storedEntries;
+        else
+            ++m_Stats.zstdEntries;
+
+        // Stored items are written straight from the caller's bytes.
+        const std::vector<std::byte>& payload = p.compression == VpkCompression::eNone ? it.bytes : p.packed;
+
+        e.compression = p.compression;
+        e.dictionary  = p.dictionary;
+        e.rawSize     = static_cast<uint64_t>(it.bytes.size());
+        e.packedSize  = static_cast<uint64_t>(payload.size());
+        e.dataOffset  = m_Offset;
+
+        if (!payload.empty())
+        {
+            const uint64_t alignment = payloadAlignment(it.type);
+            const bool     volumes   = m_Options.volumeSize > 0;
+            std::ofstream& out       = volumes ? volumeFor(payload.size(), alignment) : m_File;
+            uint64_t&      offset    = volumes ? m_VolumeOffset : m_Offset;
+
+            padTo(out, offset, alignment);
+            e.dataOffset = offset;
+            e.volume     = static_cast<uint32_t>(m_VolumeSizes.size());
+            out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+            offset += static_cast<uint64_t>(payload.size());
+        }
+
+        if (m_Options.deduplicate && !it.bytes.empty())
+            m_Payloads.emplace(payloadKey(p), m_Entries.size());
+        m_Entries.push_back(e);
+        m_Checksums.push_back(p.checksum);
+    }
+
+    vbase::Result<void, AssetError> VpkWriterState::pump(bool final)
+    {
+        const size_t maxItems = kWindowItemsPerThread * m_Threads;
+        while (!m_Pending.empty())
+        {
+            size_t ready = 0;
+            while (ready < m_Pending.size() && ready < maxItems && isReady(m_Pending[ready]))
+                ++ready;
+
+            if (ready == 0)
+            {
+                // The head waits on its type's dictionary. Everything queued is behind it, so this
+                // point depends only on the items added, never on the thread count.
+                if (!final && m_PendingBytes < kWindowBytes)
+                    break;
+                if (!decide(m_Pending.front().item->type))
+                    return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+                continue;
+            }
+            if (!final && m_Pending.size() < maxItems && m_PendingBytes < kWindowBytes)
+                break;
+
+            if (m_Options.deduplicate)
+                findDuplicates(ready);
+
+            std::atomic<bool> failed {false};
+            runJobs(ready, resolveThreadCount(m_Threads, ready), [&](size_t k) {
+                Pending& p = m_Pending[k];
+                if (p.tombstone || p.duplicate)
+                    return;
+                if (m_Options.checksums)
+                    p.checksum = XXH3_64bits(p.item->bytes.data(), p.item->bytes.size());
+                if (!pack(p))
+                    failed = true;
+            });
+            if (failed)
+                return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+
+            for (size_t k = 0; k < ready; ++k)
+            {
+                append(m_Pending.front());
+                m_PendingBytes -= m_Pending.front().item->bytes.size();
+                m_Pending.pop_front();
+            }
+        }
+
+        if (!m_File || m_VolumeFailed || m_Volume.fail())
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+        return vbase::Result<void, AssetError>::ok();
+    }
+
+    uint32_t VpkWriterState::payloadAlignment(VAssetType type) const
+    {
+        const auto it = m_Options.typeAlignment.find(type);
+        return it == m_Options.typeAlignment.end() ? m_Options.payloadAlignment
+                                                   : std::max(m_Options.payloadAlignment, it->second);
+    }
+
+    // Zero-fill `out`, positioned at `offset`, up to the next multiple of `alignment` (a power of two).
+    void VpkWriterState::padTo(std::ofstream& out, uint64_t& offset, uint64_t alignment)
+    {
+        static constexpr char zeros[4096] = {};
+
+        uint64_t pad = (alignment - offset % alignment) % alignment;
+        offset += pad;
+        while (pad > 0)
+        {
+            const uint64_t n = std::min<uint64_t>(pad, sizeof(zeros));
+            out.write(zeros, static_cast<std::streamsize>(n));
+            pad -= n;
+        }
+    }
+
+    // Tables are 8-byte aligned so readers can use a mapped image in place.
+    void VpkWriterState::alignTables() { padTo(m_File, m_Offset, 8); }
+
+    std::ofstream& VpkWriterState::volumeFor(uint64_t size, uint64_t alignment)
+    {
+        const uint64_t start = (m_VolumeOffset + alignment - 1) / alignment * alignment;
+        if (m_Volume.is_open() && m_VolumeOffset > 0 && start + size > m_Options.volumeSize)
+            closeVolume();
+
+        if (!m_Volume.is_open())
+        {
+            if (m_VolumeSizes.size() >= kVpkMaxVolumes)
+                m_VolumeFailed = true;
+            else
+                m_Volume.open(vpkVolumePath(m_Path, static_cast<uint32_t>(m_VolumeSizes.size())),
+                              std::ios::binary | std::ios::trunc);
+        }
+        return m_Volume;
+    }
+
+    void VpkWriterState::closeVolume()
+    {
+        m_Volume.close();
+        m_VolumeFailed = m_VolumeFailed || m_Volume.fail();
+        m_VolumeSizes.push_back(m_VolumeOffset);
+        m_VolumeBytes += m_VolumeOffset;
+        m_VolumeOffset = 0;
+    }
+
+    void VpkWriterState::frontCodePaths(std::vector<VpkDirectoryNode>& directories,
+                                        std::vector<uint32_t>&         pathBuckets,
+                                        std::string&                   pathData)
+    {
+        auto pathOf = [this](const auto& r) {
+            return std::string_view(m_StringTable).substr(r.pathOffset, r.pathSize);
+        };
+
+        std::vector<uint32_t> order(m_Entries.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return pathOf(m_Entries[a]) < pathOf(m_Entries[b]);
+        });
+
+        // Entries and registry records share string table slices, so a slice's offset names its rank.
+        std::unordered_map<uint32_t, uint32_t> rankOf;
+        std::string_view                       previous;
+        for (uint32_t rank = 0; rank < static_cast<uint32_t>(order.size()); ++rank)
+        {
+            const std::string_view path = pathOf(m_Entries[order[rank]]);
+            size_t                 shared = 0;
+            if (rank % kVpkPathBucketSize == 0)
+            {
+                pathBuckets.push_back(static_cast<uint32_t>(pathData.size()));
+            }
+            else
+            {
+                while (shared < path.size() && shared < previous.size() && path[shared] == previous[shared])
+                    ++shared;
+            }
+
+            appendVarint(pathData, shared);
+            appendVarint(pathData, path.size() - shared);
+            pathData.append(path.substr(shared));
+            rankOf.emplace(m_Entries[order[rank]].pathOffset, rank);
+            previous = path;
+        }
+
+        std::string names;
+        for (auto& node : directories)
+        {
+            const std::string_view name = std::string_view(m_StringTable).substr(node.nameOffset, node.nameSize);
+            node.nameOffset             = static_cast<uint32_t>(names.size());
+            names.append(name);
+        }
+
+        for (auto& e : m_Entries)
+            e.pathOffset = rankOf.at(e.pathOffset);
+        for (auto& r : m_Registry)
+            r.pathOffset = rankOf.at(r.pathOffset);
+        m_StringTable = std::move(names);
+    }
+
+    vbase::Result<void, AssetError> VpkWriterState::finish()
+    {
+        if (!m_File.is_open())
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+        if (auto r = pump(true); !r)
+            return r;
+        if (m_Volume.is_open())
+            closeVolume();
+        if (m_VolumeFailed)
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+
+        m_Header.fileCount = static_cast<uint32_t>(m_Entries.size());
+
+        // Index, sorted by path hash (payload order is unaffected). Checksums follow their entries.
+        {
+            std::vector<size_t> order(m_Entries.size());
+            for (size_t i = 0; i < order.size(); ++i)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+                return m_Entries[a].pathHash64 < m_Entries[b].pathHash64;
+            });
+
+            std::vector<VpkEntry> entries(m_Entries.size());
+            std::vector<uint64_t> checksums(m_Checksums.size());
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                entries[i]   = m_Entries[order[i]];
+                checksums[i] = m_Checksums[order[i]];
+            }
+            m_Entries   = std::move(entries);
+            m_Checksums = std::move(checksums);
+        }
+
+        std::vector<VpkDirectoryNode> directories;
+        std::vector<uint32_t>         directoryFiles;
+        buildDirectoryTable(m_Entries, m_StringTable, directories, directoryFiles);
+
+        std::vector<uint32_t> pathBuckets;
+        std::string           pathData;
+        if (m_Options.frontCodedPaths)
+            frontCodePaths(directories, pathBuckets, pathData);
+
+        // String table
+        m_Header.stringOffset = m_Offset;
+        m_Header.stringSize   = static_cast<uint64_t>(m_StringTable.size());
+        if (!m_StringTable.empty())
+        {
+            m_File.write(m_StringTable.data(), static_cast<std::streamsize>(m_StringTable.size()));
+            m_Offset += static_cast<uint64_t>(m_StringTable.size());
+        }
+
+        alignTables();
+        m_Header.indexOffset = m_Offset;
+        m_Header.indexSize   = static_cast<uint32_t>(m_Entries.size() * sizeof(VpkEntry));
+        if (!m_Entries.empty())
+        {
+            m_File.write(reinterpret_cast<const char*>(m_Entries.data()),
+                         static_cast<std::streamsize>(m_Header.indexSize));
+            m_Offset += m_Header.indexSize;
+        }
+
+        // Registry
+        alignTables();
+        m_Header.registryOffset = m_Offset;
+        m_Header.registrySize   = static_cast<uint32_t>(m_Registry.size() * sizeof(VpkAssetRegistryEntry));
+        m_Header.registryCount  = static_cast<uint32_t>(m_Registry.size());
+        if (!m_Registry.empty())
+        {
+            m_File.write(reinterpret_cast<const char*>(m_Registry.data()),
+                         static_cast<std::streamsize>(m_Header.registrySize));
+            m_Offset += m_Header.registrySize;
+        }
+
+        // Sections
+        std::vector<VpkSection> sections;
+        {
+            alignTables();
+            VpkSection section {};
+            section.kind   = VpkSectionKind::eDirectories;
+            section.count  = static_cast<uint32_t>(directories.size());
+            section.offset = m_Offset;
+            section.size   = static_cast<uint64_t>(directories.size() * sizeof(VpkDirectoryNode) +
+                                                 directoryFiles.size() * sizeof(uint32_t));
+            m_File.write(reinterpret_cast<const char*>(directories.data()),
+                         static_cast<std::streamsize>(directories.size() * sizeof(VpkDirectoryNode)));
+            m_File.write(reinterpret_cast<const char*>(directoryFiles.data()),
+                         static_cast<std::streamsize>(directoryFiles.size() * sizeof(uint32_t)));
+            m_Offset += section.size;
+            sections.push_back(section);
+        }
+
+        if (m_Options.frontCodedPaths)
+        {
+            alignTables();
+            VpkSection section {};
+            section.kind   = VpkSectionKind::ePathBuckets;
+            section.count  = static_cast<uint32_t>(pathBuckets.size());
+            section.offset = m_Offset;
+            section.size   = static_cast<uint64_t>(pathBuckets.size() * sizeof(uint32_t) + pathData.size());
+            m_File.write(reinterpret_cast<const char*>(pathBuckets.data()),
+                         static_cast<std::streamsize>(pathBuckets.size() * sizeof(uint32_t)));
+            m_File.write(pathData.data(), static_cast<std::streamsize>(pathData.size()));
+            m_Offset += section.size;
+            sections.push_back(section);
+        }
+
+        // Dependency edges between registered assets, as registry indices. Edges to assets outside the
+        // pack, self edges and repeats are dropped; nothing is written when no edge is left.
+        {
+            std::unordered_map<vbase::UUID, uint32_t> registryIndex;
+            for (size_t i = 0; i < m_Registry.size(); ++i)
+                registryIndex.emplace(m_Registry[i].uuid, static_cast<uint32_t>(i));
+
+            std::vector<VpkDependencyRange> ranges(m_Registry.size());
+            std::vector<uint32_t>           targets;
+            for (size_t i = 0; i < m_Registry.size(); ++i)
+            {
+                ranges[i].first = static_cast<uint32_t>(targets.size());
+                for (const auto& uuid : m_Dependencies[i])
+                {
+                    const auto it = registryIndex.find(uuid);
+                    if (it == registryIndex.end() || it->second == i ||
+                        std::find(targets.begin() + ranges[i].first, targets.end(), it->second) != targets.end())
+                        continue;
+                    targets.push_back(it->second);
+                }
+                ranges[i].count = static_cast<uint32_t>(targets.size()) - ranges[i].first;
+            }
+
+            if (!targets.empty())
+            {
+                alignTables();
+                VpkSection section {};
+                section.kind   = VpkSectionKind::eDependencies;
+                section.count  = static_cast<uint32_t>(ranges.size());
+                section.offset = m_Offset;
+                section.size   = static_cast<uint64_t>(ranges.size() * sizeof(VpkDependencyRange) +
+                                                     targets.size() * sizeof(uint32_t));
+                m_File.write(reinterpret_cast<const char*>(ranges.data()),
+                             static_cast<std::streamsize>(ranges.size() * sizeof(VpkDependencyRange)));
+                m_File.write(reinterpret_cast<const char*>(targets.data()),
+                             static_cast<std::streamsize>(targets.size() * sizeof(uint32_t)));
+                m_Offset += section.size;
+                sections.push_back(section);
+            }
+        }
+
+        // UUID -> index position, so UUID references skip path building and hashing at runtime. The
+        // registry shares each entry's string-table slice, which identifies its sorted position.
+        {
+            std::unordered_map<uint32_t, uint32_t> positionOfPath;
+            for (size_t i = 0; i < m_Entries.size(); ++i)
+                positionOfPath.emplace(m_Entries[i].pathOffset, static_cast<uint32_t>(i));
+
+            std::vector<VpkUuidIndexEntry> rows;
+            rows.reserve(m_Registry.size());
+            for (size_t i = 0; i < m_Registry.size(); ++i)
+            {
+                if (!m_Registry[i].uuid.valid())
+                    continue;
+                VpkUuidIndexEntry row {};
+                row.uuid     = m_Registry[i].uuid;
+                row.entry    = positionOfPath.at(m_Registry[i].pathOffset);
+                row.registry = static_cast<uint32_t>(i);
+                rows.push_back(row);
+            }
+            std::stable_sort(rows.begin(), rows.end(), [](const VpkUuidIndexEntry& a, const VpkUuidIndexEntry& b) {
+                return uuidLess(a.uuid, b.uuid);
+            });
+
+            if (!rows.empty())
+            {
+                alignTables();
+                VpkSection section {};
+                section.kind   = VpkSectionKind::eUuidIndex;
+                section.count  = static_cast<uint32_t>(rows.size());
+                section.offset = m_Offset;
+                section.size   = static_cast<uint64_t>(rows.size() * sizeof(VpkUuidIndexEntry));
+                m_File.write(reinterpret_cast<const char*>(rows.data()), static_cast<std::streamsize>(section.size));
+                m_Offset += section.size;
+                sections.push_back(section);
+            }
+        }
+
+        if (m_Options.checksums)
+        {
+            alignTables();
+            VpkSection section {};
+            section.kind   = VpkSectionKind::eChecksums;
+            section.count  = static_cast<uint32_t>(m_Checksums.size());
+            section.offset = m_Offset;
+            section.size   = static_cast<uint64_t>(m_Checksums.size() * sizeof(uint64_t));
+            m_File.write(reinterpret_cast<const char*>(m_Checksums.data()), static_cast<std::streamsize>(section.size));
+            m_Offset += section.size;
+            sections.push_back(section);
+        }
+
+        if (m_Options.volumeSize > 0)
+        {
+            alignTables();
+            VpkSection section {};
+            section.kind   = VpkSectionKind::eVolumes;
+            section.count  = static_cast<uint32_t>(m_VolumeSizes.size());
+            section.offset = m_Offset;
+            section.size   = static_cast<uint64_t>(m_VolumeSizes.size() * sizeof(uint64_t));
+            m_File.write(reinterpret_cast<const char*>(m_VolumeSizes.data()),
+                         static_cast<std::streamsize>(section.size));
+            m_Offset += section.size;
+            sections.push_back(section);
+        }
+
+        if (!m_DictionaryEntries.empty())
+        {
+            for (size_t i = 0; i < m_DictionaryEntries.size(); ++i)
+            {
+                m_DictionaryEntries[i].offset = m_Offset;
+                m_File.write(reinterpret_cast<const char*>(m_DictionaryBodies[i].data()),
+                             static_cast<std::streamsize>(m_DictionaryBodies[i].size()));
+                m_Offset += m_DictionaryEntries[i].size;
+            }
+
+            alignTables();
+            VpkSection section {};
+            section.kind   = VpkSectionKind::eDictionaries;
+            section.count  = static_cast<uint32_t>(m_DictionaryEntries.size());
+            section.offset = m_Offset;
+            section.size   = static_cast<uint64_t>(m_DictionaryEntries.size() * sizeof(VpkDictionaryEntry));
+            m_File.write(reinterpret_cast<const char*>(m_DictionaryEntries.data()),
+                         static_cast<std::streamsize>(section.size));
+            m_Offset += section.size;
+            sections.push_back(section);
+        }
+
+        alignTables();
+        m_Header.sectionOffset = m_Offset;
+        m_Header.sectionCount  = static_cast<uint32_t>(sections.size());
+        if (!sections.empty())
+        {
+            const uint64_t size = static_cast<uint64_t>(sections.size() * sizeof(VpkSection));
+            m_File.write(reinterpret_cast<const char*>(sections.data()), static_cast<std::streamsize>(size));
+            m_Offset += size;
+        }
+
+        // Patch header
+        m_File.seekp(0, std::ios::beg);
+        m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+        m_File.close();
+
+        if (m_File.fail())
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+        return vbase::Result<void, AssetError>::ok();
+    }
+
+    VpkWriter::VpkWriter() = default;
+
+    VpkWriter::~VpkWriter() = default;
+
+    vbase::Result<void, AssetError> VpkWriter::open(vbase::StringView outPath, const VpkWriteOptions& options)
+    {
+        m_State         = std::make_unique<VpkWriterState>();
+        m_FinishedStats = {};
+        return m_State->open(outPath, options);
+    }
+
+    vbase::Result<void, AssetError> VpkWriter::add(VpkWriteItem item)
+    {
+        if (!m_State)
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+        return m_State->add(nullptr, std::move(item));
+    }
+
+    vbase::Result<void, AssetError> VpkWriter::addTombstone(vbase::StringView logicalPath)
+    {
+        if (!m_State)
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+        return m_State->addTombstone(logicalPath);
+    }
+
+    vbase::Result<void, AssetError> VpkWriter::finish()
+    {
+        if (!m_State)
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+        auto r          = m_State->finish();
+        m_FinishedStats = m_State->stats();
+        m_State.reset();
+        return r;
+    }
+
+    size_t VpkWriter::entryCount() const { return m_State ? m_State->entryCount() : 0; }
+
+    uint64_t VpkWriter::bytesWritten() const { return m_State ? m_State->bytesWritten() : 0; }
+
+    VpkWriteStats VpkWriter::stats() const { return m_State ? m_State->stats() : m_FinishedStats; }
+
+    vbase::Result<void, AssetError>
+    writeVpk(vbase::StringView outPath, const std::vector<VpkWriteItem>& items, int zstdLevel)
+    {
+        VpkWriteOptions options {};
+        options.zstdLevel = zstdLevel;
+        return writeVpk(outPath, items, options);
+    }
+
+    vbase::Result<void, AssetError>
+    writeVpk(vbase::StringView outPath, const std::vector<VpkWriteItem>& items, const VpkWriteOptions& options)
+    {
+        // The items outlive the writer, so they are queued by reference rather than copied.
+        VpkWriterState writer;
+        if (auto r = writer.open(outPath, options); !r)
+            return r;
+        for (const auto& item : items)
+        {
+            if (auto r = writer.add(&item, {}); !r)
+                return r;
+        }
+        return writer.finish();
+    }
+
+    vbase::Result<VpkPatchStats, AssetError> writeVpkPatch(vbase::StringView      outPath,
+                                                           vbase::StringView      basePath,
+                                                           vbase::StringView      newPath,
+                                                           const VpkWriteOptions& options)
+    {
+        auto base = openVpk(basePath);
+        if (!base)
+            return vbase::Result<VpkPatchStats, AssetError>::err(base.error());
+        auto next = openVpk(newPath);
+        if (!next)
+            return vbase::Result<VpkPatchStats, AssetError>::err(next.error());
+        const VpkReadOnly& from = base.value();
+        const VpkReadOnly& to   = next.value();
+
+        // The writer gives an entry and its registry record the same string table slice.
+        std::unordered_map<uint32_t, const VpkAssetRegistryEntry*> registryByPath;
+        for (const auto& r : to.registry)
+            registryByPath.emplace(r.pathOffset, &r);
+
+        // Visit the new entries in payload order so the new package is read front to back.
+        std::vector<const VpkEntry*> order;
+        order.reserve(to.entries.size());
+        for (const auto& e : to.entries)
+            if (!(e.flags & kVpkEntryFlagTombstone))
+                order.push_back(&e);
+        std::stable_sort(order.begin(), order.end(), [](const VpkEntry* a, const VpkEntry* b) {
+            return payloadBefore(*a, *b);
+        });
+
+        VpkWriteOptions patchOptions = options;
+        patchOptions.patch           = true;
+
+        VpkWriterState writer;
+        if (auto r = writer.open(outPath, patchOptions); !r)
+            return vbase::Result<VpkPatchStats, AssetError>::err(r.error());
+
+        VpkPatchStats          stats;
+        std::vector<std::byte> baseBytes;
+        std::string            scratch;
+        for (const VpkEntry* e : order)
+        {
+            const std::string_view path = vpkPathOf(to, *e, scratch);
+            auto                   raw  = detail::readEntry(to, newPath, *e);
+            if (!raw)
+                return vbase::Result<VpkPatchStats, AssetError>::err(raw.error());
+
+            const VpkEntry* old = findVpkEntry(from, path);
+            if (old && old->rawSize == e->rawSize)
+            {
+                if (auto r = detail::readEntryInto(from, basePath, *old, baseBytes); !r)
+                    return vbase::Result<VpkPatchStats, AssetError>::err(r.error());
+                if (baseBytes == raw.value())
+                {
+                    ++stats.unchanged;
+                    continue;
+                }
+            }
+            ++(old ? stats.changed : stats.added);
+
+            VpkWriteItem item;
+            item.logicalPath   = std::string(path);
+            item.bytes         = std::move(raw.value());
+            item.allowCompress = e->compression != VpkCompression::eNone;
+            if (auto it = registryByPath.find(e->pathOffset); it != registryByPath.end())
+            {
+                item.uuid = it->second->uuid;
+                item.type = it->second->type;
+
+                // Outgoing edges; the writer keeps those whose target is also in the patch.
+                const size_t index = static_cast<size_t>(it->second - to.registry.data());
+                if (index < to.dependencies.size())
+                {
+                    const VpkDependencyRange& range = to.dependencies[index];
+                    for (uint32_t k = range.first; k < range.first + range.count; ++k)
+                        item.dependencies.push_back(to.registry[to.dependencyTargets[k]].uuid);
+                }
+            }
+            if (auto r = writer.add(nullptr, std::move(item)); !r)
+                return vbase::Result<VpkPatchStats, AssetError>::err(r.error());
+        }
+
+        for (const auto& e : from.entries)
+        {
+            const std::string_view path = vpkPathOf(from, e, scratch);
+            if ((e.flags & kVpkEntryFlagTombstone) || findVpkEntry(to, path))
+                continue;
+            ++stats.removed;
+            if (auto r = writer.addTombstone(path); !r)
+                return vbase::Result<VpkPatchStats, AssetError>::err(r.error());
+        }
+
+        if (auto r = writer.finish(); !r)
+            return vbase::Result<VpkPatchStats, AssetError>::err(r.error());
+        return vbase::Result<VpkPatchStats, AssetError>::ok(stats);
     }
 } // namespace vasset
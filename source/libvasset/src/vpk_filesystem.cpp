@@ -1,6 +1,23 @@
-#include "vasset/vpk.hpp"
+#include "vpk_internal.hpp"
 
+#include <xxhash.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace vasset
@@ -10,15 +27,18 @@ namespace vasset
         class VpkMemoryFile final : public vfilesystem::IFile
         {
         public:
-            explicit VpkMemoryFile(std::vector<std::byte> data) : m_Data(std::move(data)) {}
+            explicit VpkMemoryFile(std::vector<std::byte> data) :
+                m_Data(std::move(data)), m_Size(static_cast<uint64_t>(m_Data.size()))
+            {}
 
-            uint64_t size() const override { return static_cast<uint64_t>(m_Data.size()); }
+            uint64_t size() const override { return m_Size; }
 
             uint64_t tell() const override { return m_Pos; }
 
             bool seek(uint64_t pos) override
             {
-                if (pos > m_Data.size())
+                // After readAllBytes() handed the buffer out there is nothing left to seek within.
+                if (pos > m_Size || m_Data.size() != m_Size)
                     return false;
                 m_Pos = pos;
                 return true;
@@ -40,6 +60,15 @@ namespace vasset
             {
                 if (m_Pos >= m_Data.size())
                     return {};
+
+                // Whole-file read: hand over the decoded buffer instead of copying it. The file is
+                // exhausted afterwards (size() still reports the original length).
+                if (m_Pos == 0)
+                {
+                    m_Pos = m_Size;
+                    return std::move(m_Data);
+                }
+
                 std::vector<std::byte> out;
                 out.resize(m_Data.size() - static_cast<size_t>(m_Pos));
                 std::memcpy(out.data(), m_Data.data() + static_cast<size_t>(m_Pos), out.size());
@@ -49,36 +78,802 @@ namespace vasset
 
         private:
             std::vector<std::byte> m_Data;
+            uint64_t               m_Size {0};
+            uint64_t               m_Pos {0};
+        };
+
+        // An uncompressed entry served straight out of an in-memory image (mapping or embedded blob).
+        // Holds a reference on the image owner so the bytes stay valid after the filesystem is gone.
+        class VpkBorrowedFile final : public vfilesystem::IFile
+        {
+        public:
+            VpkBorrowedFile(std::shared_ptr<const void> owner, vbase::ConstByteSpan bytes) :
+                m_Owner(std::move(owner)), m_Bytes(bytes)
+            {}
+
+            uint64_t size() const override { return static_cast<uint64_t>(m_Bytes.size()); }
+
+            uint64_t tell() const override { return m_Pos; }
+
+            bool seek(uint64_t pos) override
+            {
+                if (pos > m_Bytes.size())
+                    return false;
+                m_Pos = pos;
+                return true;
+            }
+
+            size_t read(void* dst, size_t bytes) override
+            {
+                const size_t avail = (m_Pos < m_Bytes.size()) ? (m_Bytes.size() - static_cast<size_t>(m_Pos)) : 0;
+                const size_t n     = (bytes < avail) ? bytes : avail;
+                if (n)
+                    std::memcpy(dst, m_Bytes.data() + static_cast<size_t>(m_Pos), n);
+                m_Pos += static_cast<uint64_t>(n);
+                return n;
+            }
+
+            size_t write(const void*, size_t) override { return 0; } // read-only
+
+            std::vector<std::byte> readAllBytes() override
+            {
+                if (m_Pos >= m_Bytes.size())
+                    return {};
+                const auto rest = m_Bytes.subspan(static_cast<size_t>(m_Pos));
+                m_Pos           = static_cast<uint64_t>(m_Bytes.size());
+                return std::vector<std::byte>(rest.begin(), rest.end());
+            }
+
+        private:
+            std::shared_ptr<const void> m_Owner;
+            vbase::ConstByteSpan        m_Bytes;
+            uint64_t                    m_Pos {0};
+        };
+
+        // Where an entry's packed bytes live: an in-memory image (kept alive by its owner) or the
+        // shared positional-read handle of the package or of the entry's volume. Also pins the
+        // package dictionaries, so a DDict resolved for the entry outlives the filesystem.
+        struct VpkPackedSource
+        {
+            std::shared_ptr<const VpkFileHandle>   file;
+            std::shared_ptr<const void>            imageOwner;
+            vbase::ConstByteSpan                   image;
+            std::shared_ptr<const VpkDictionaries> dictionaries;
+
+            bool inMemory() const { return imageOwner != nullptr; }
+
+            // Read n bytes at absolute offset `offset` of the image or file.
+            bool readAt(uint64_t offset, void* dst, size_t n) const
+            {
+                if (inMemory())
+                {
+                    if (offset > image.size() || n > image.size() - offset)
+                        return false;
+                    std::memcpy(dst, image.data() + offset, n);
+                    return true;
+                }
+                return file && file->readAt(offset, dst, n);
+            }
+        };
+
+        // Serves one large entry without materializing it: compressed entries are decoded
+        // incrementally with a private ZSTD_DCtx into the caller's buffer, stored entries are read
+        // positionally. Packed bytes come from the in-memory image when there is one, otherwise in
+        // ZSTD_DStreamInSize() chunks from the shared file handle, so peak memory is one input chunk
+        // plus the zstd window rather than rawSize + packedSize.
+        class VpkStreamingFile final : public vfilesystem::IFile
+        {
+        public:
+            VpkStreamingFile(const VpkEntry& entry, VpkPackedSource source, const ZSTD_DDict* ddict) :
+                m_Entry(entry), m_Source(std::move(source)), m_DDict(ddict)
+            {
+                if (m_Entry.compression == VpkCompression::eZstd)
+                {
+                    m_DCtx.reset(ZSTD_createDCtx());
+                    if (!m_Source.inMemory())
+                        m_InBuf.resize(ZSTD_DStreamInSize());
+                }
+                restart();
+            }
+
+            uint64_t size() const override { return m_Entry.rawSize; }
+
+            uint64_t tell() const override { return m_Pos; }
+
+            bool seek(uint64_t pos) override
+            {
+                if (pos > m_Entry.rawSize)
+                    return false;
+
+                if (m_Entry.compression == VpkCompression::eNone)
+                {
+                    m_Pos = pos;
+                    return true;
+                }
+
+                // A zstd stream only runs forward: going back restarts the frame, going forward
+                // decodes and discards up to the target.
+                if (pos < m_Pos)
+                    restart();
+
+                std::array<std::byte, 16 * 1024> scratch {};
+                while (m_Pos < pos)
+                {
+                    const size_t want = static_cast<size_t>(std::min<uint64_t>(scratch.size(), pos - m_Pos));
+                    if (read(scratch.data(), want) != want)
+                        return false;
+                }
+                return true;
+            }
+
+            size_t read(void* dst, size_t bytes) override
+            {
+                if (m_Failed || m_Pos >= m_Entry.rawSize)
+                    return 0;
+
+                bytes = static_cast<size_t>(std::min<uint64_t>(bytes, m_Entry.rawSize - m_Pos));
+
+                if (m_Entry.compression == VpkCompression::eNone)
+                {
+                    if (!readPacked(m_Pos, dst, bytes))
+                    {
+                        m_Failed = true;
+                        return 0;
+                    }
+                    m_Pos += static_cast<uint64_t>(bytes);
+                    return bytes;
+                }
+
+                ZSTD_outBuffer out {dst, bytes, 0};
+                while (out.pos < out.size)
+                {
+                    if (m_In.pos == m_In.size && !refill())
+                        break;
+
+                    const size_t outBefore = out.pos;
+                    const size_t inBefore  = m_In.pos;
+                    const size_t r         = ZSTD_decompressStream(m_DCtx.get(), &out, &m_In);
+                    if (ZSTD_isError(r))
+                    {
+                        m_Failed = true;
+                        break;
+                    }
+                    if (out.pos == outBefore && m_In.pos == inBefore && m_PackedPos == m_Entry.packedSize)
+                        break; // truncated frame: no input left and no progress
+                }
+
+                m_Pos += static_cast<uint64_t>(out.pos);
+                return out.pos;
+            }
+
+            size_t write(const void*, size_t) override { return 0; } // read-only
+
+            std::vector<std::byte> readAllBytes() override
+            {
+                if (m_Pos >= m_Entry.rawSize)
+                    return {};
+                std::vector<std::byte> out;
+                out.resize(static_cast<size_t>(m_Entry.rawSize - m_Pos));
+                out.resize(read(out.data(), out.size()));
+                return out;
+            }
+
+        private:
+            // Random access into the packed payload (stored entries and zstd input refills).
+            bool readPacked(uint64_t offset, void* dst, size_t n) const
+            {
+                return m_Source.readAt(m_Entry.dataOffset + offset, dst, n);
+            }
+
+            bool refill()
+            {
+                if (m_PackedPos >= m_Entry.packedSize)
+                    return false;
+
+                const size_t n =
+                    static_cast<size_t>(std::min<uint64_t>(m_InBuf.size(), m_Entry.packedSize - m_PackedPos));
+                if (!readPacked(m_PackedPos, m_InBuf.data(), n))
+                {
+                    m_Failed = true;
+                    return false;
+                }
+                m_In = ZSTD_inBuffer {m_InBuf.data(), n, 0};
+                m_PackedPos += static_cast<uint64_t>(n);
+                return true;
+            }
+
+            void restart()
+            {
+                m_Pos    = 0;
+                m_Failed = false;
+                m_In     = ZSTD_inBuffer {nullptr, 0, 0};
+
+                if (m_Entry.compression != VpkCompression::eZstd)
+                    return;
+
+                ZSTD_DCtx_reset(m_DCtx.get(), ZSTD_reset_session_only);
+                if (m_DDict)
+                    ZSTD_DCtx_refDDict(m_DCtx.get(), m_DDict);
+                m_PackedPos = 0;
+
+                // An in-memory image is fed to zstd in place, as a single input buffer.
+                const vbase::ConstByteSpan image = m_Source.image;
+                if (m_Source.inMemory() && m_Entry.dataOffset <= image.size() &&
+                    m_Entry.packedSize <= image.size() - m_Entry.dataOffset)
+                {
+                    m_In        = ZSTD_inBuffer {image.data() + m_Entry.dataOffset,
+                                          static_cast<size_t>(m_Entry.packedSize),
+                                          0};
+                    m_PackedPos = m_Entry.packedSize;
+                }
+            }
+
+            VpkEntry          m_Entry;
+            VpkPackedSource   m_Source;
+            const ZSTD_DDict* m_DDict {nullptr};
+
+            detail::ZstdDCtxPtr    m_DCtx;
+            std::vector<std::byte> m_InBuf;
+            ZSTD_inBuffer          m_In {nullptr, 0, 0};
+            uint64_t               m_PackedPos {0};
+            uint64_t               m_Pos {0};
+            bool                   m_Failed {false};
+        };
+
+        // A seekable eZstdFrames entry. The seek table is loaded at open; read() decodes only the
+        // frames it overlaps, keeping the most recent one so sequential small reads decode each
+        // frame once. Memory use is one packed plus one raw frame regardless of entry size.
+        class VpkFramedFile final : public vfilesystem::IFile
+        {
+        public:
+            // Nullptr when the entry's frame table is missing or inconsistent.
+            static std::unique_ptr<VpkFramedFile>
+            open(const VpkEntry& entry, VpkPackedSource source, const ZSTD_DDict* ddict)
+            {
+                auto readPacked = [&](uint64_t offset, void* dst, size_t n) -> bool {
+                    return source.readAt(entry.dataOffset + offset, dst, n);
+                };
+
+                detail::VpkFrameTable table;
+                if (!detail::readFrameTable(entry, readPacked, table))
+                    return nullptr;
+                return std::unique_ptr<VpkFramedFile>(
+                    new VpkFramedFile(entry, std::move(source), ddict, std::move(table)));
+            }
+
+            uint64_t size() const override { return m_Entry.rawSize; }
+
+            uint64_t tell() const override { return m_Pos; }
+
+            bool seek(uint64_t pos) override
+            {
+                if (pos > m_Entry.rawSize)
+                    return false;
+                m_Pos = pos;
+                return true;
+            }
+
+            size_t read(void* dst, size_t bytes) override
+            {
+                size_t done = 0;
+                while (done < bytes && m_Pos < m_Entry.rawSize)
+                {
+                    const size_t frame = static_cast<size_t>(m_Pos / m_Table.frameRawSize);
+                    if (!loadFrame(frame))
+                        break;
+
+                    const size_t inFrame = static_cast<size_t>(m_Pos - m_Table.rawBegin(frame));
+                    const size_t n       = std::min(bytes - done, m_Frame.size() - inFrame);
+                    std::memcpy(static_cast<std::byte*>(dst) + done, m_Frame.data() + inFrame, n);
+                    done += n;
+                    m_Pos += static_cast<uint64_t>(n);
+                }
+                return done;
+            }
+
+            size_t write(const void*, size_t) override { return 0; } // read-only
+
+            std::vector<std::byte> readAllBytes() override
+            {
+                if (m_Pos >= m_Entry.rawSize)
+                    return {};
+                std::vector<std::byte> out;
+                out.resize(static_cast<size_t>(m_Entry.rawSize - m_Pos));
+                out.resize(read(out.data(), out.size()));
+                return out;
+            }
+
+        private:
+            VpkFramedFile(const VpkEntry&       entry,
+                          VpkPackedSource       source,
+                          const ZSTD_DDict*     ddict,
+                          detail::VpkFrameTable table) :
+                m_Entry(entry), m_Source(std::move(source)), m_DDict(ddict), m_Table(std::move(table))
+            {}
+
+            bool loadFrame(size_t frame)
+            {
+                if (frame == m_FrameIndex)
+                    return true;
+
+                const uint64_t packedBegin = m_Table.packedBegin(frame);
+                const size_t   packedSize  = static_cast<size_t>(m_Table.packedEnd(frame) - packedBegin);
+                const size_t   rawSize     = static_cast<size_t>(
+                    std::min<uint64_t>(m_Table.frameRawSize, m_Entry.rawSize - m_Table.rawBegin(frame)));
+
+                const std::byte* src = nullptr;
+                if (m_Source.inMemory())
+                {
+                    const uint64_t at = m_Entry.dataOffset + packedBegin;
+                    if (at > m_Source.image.size() || packedSize > m_Source.image.size() - at)
+                        return false;
+                    src = m_Source.image.data() + at;
+                }
+                else
+                {
+                    m_Packed.resize(packedSize);
+                    if (!m_Source.readAt(m_Entry.dataOffset + packedBegin, m_Packed.data(), packedSize))
+                        return false;
+                    src = m_Packed.data();
+                }
+
+                m_FrameIndex = SIZE_MAX;
+                m_Frame.resize(rawSize);
+                if (!detail::decompressFrame(detail::threadDCtx(), m_DDict, m_Frame.data(), rawSize, src, packedSize))
+                    return false;
+
+                m_FrameIndex = frame;
+                return true;
+            }
+
+            VpkEntry              m_Entry;
+            VpkPackedSource       m_Source;
+            const ZSTD_DDict*     m_DDict {nullptr};
+            detail::VpkFrameTable m_Table;
+
+            std::vector<std::byte> m_Packed;
+            std::vector<std::byte> m_Frame;
+            size_t                 m_FrameIndex {SIZE_MAX};
             uint64_t               m_Pos {0};
         };
     } // namespace
 
-    VpkFileSystem::VpkFileSystem(std::string vpkPath) : m_Path(std::move(vpkPath)) {}
+    // LRU cache of decoded entries, keyed by index entry (stable for the package's lifetime) and
+    // bounded by the bytes it holds. Buffers are shared with the files opened from them.
+    class VpkEntryCache final
+    {
+    public:
+        using Buffer = std::shared_ptr<const std::vector<std::byte>>;
+
+        explicit VpkEntryCache(uint64_t budget) : m_Budget(budget) {}
+
+        // Entries are keyed by payload position (volume, offset), so paths that share a deduplicated
+        // payload share one buffer. Empty payloads are never cached: they need no decoding and may
+        // share an offset.
+        static uint64_t keyOf(const VpkEntry& e) { return (uint64_t {e.volume} << 48) | e.dataOffset; }
+
+        // The cached buffer of `key` (now most recently used), or null. Counts a hit or a miss.
+        Buffer find(uint64_t key)
+        {
+            std::lock_guard lock(m_Mutex);
+            auto            it = m_Index.find(key);
+            if (it == m_Index.end())
+            {
+                ++m_Stats.misses;
+                return nullptr;
+            }
+            ++m_Stats.hits;
+            m_Lru.splice(m_Lru.begin(), m_Lru, it->second);
+            return it->second->bytes;
+        }
+
+        // Whether `key` is cached, without touching its recency or the hit/miss counters.
+        bool contains(uint64_t key) const
+        {
+            std::lock_guard lock(m_Mutex);
+            return m_Index.contains(key);
+        }
+
+        // Cache `bytes` for `key`, evicting from the cold end until it fits. When another thread cached
+        // the same entry first, its buffer is kept and returned instead.
+        Buffer insert(uint64_t key, std::vector<std::byte> bytes)
+        {
+            auto buffer = std::make_shared<const std::vector<std::byte>>(std::move(bytes));
+
+            std::lock_guard lock(m_Mutex);
+            if (auto it = m_Index.find(key); it != m_Index.end())
+                return it->second->bytes;
+            if (buffer->size() > m_Budget)
+                return buffer;
+
+            while (!m_Lru.empty() && m_Stats.bytes + buffer->size() > m_Budget)
+            {
+                m_Stats.bytes -= m_Lru.back().bytes->size();
+                m_Index.erase(m_Lru.back().key);
+                m_Lru.pop_back();
+                ++m_Stats.evictions;
+            }
+
+            m_Lru.push_front({key, buffer});
+            m_Index.emplace(key, m_Lru.begin());
+            m_Stats.bytes += buffer->size();
+            return buffer;
+        }
 
-    VpkFileSystem::VpkFileSystem(std::vector<std::byte> blob) : m_Blob(std::move(blob)), m_Memory(true) {}
+        VpkCacheStats stats() const
+        {
+            std::lock_guard lock(m_Mutex);
+            VpkCacheStats   out = m_Stats;
+            out.entries         = static_cast<uint64_t>(m_Lru.size());
+            return out;
+        }
+
+        void clear()
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Lru.clear();
+            m_Index.clear();
+            m_Stats.bytes = 0;
+        }
+
+        uint64_t budget() const { return m_Budget; }
+
+    private:
+        struct Node
+        {
+            uint64_t key {0};
+            Buffer   bytes;
+        };
+
+        mutable std::mutex                                      m_Mutex;
+        const uint64_t                                          m_Budget;
+        std::list<Node>                                         m_Lru; // front = most recently used
+        std::unordered_map<uint64_t, std::list<Node>::iterator> m_Index;
+        VpkCacheStats                                           m_Stats;
+    };
+
+    // The background thread of VpkFileSystem::prefetch: runs posted jobs one at a time, in order.
+    // Destruction lets the running job finish, resolves the queued ones without running them and
+    // joins the thread.
+    class VpkPrefetchWorker final
+    {
+    public:
+        VpkPrefetchWorker() : m_Thread([this] { run(); }) {}
+
+        ~VpkPrefetchWorker()
+        {
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Stop = true;
+            }
+            m_Wake.notify_one();
+            m_Thread.join();
+        }
+
+        VpkPrefetchWorker(const VpkPrefetchWorker&)            = delete;
+        VpkPrefetchWorker& operator=(const VpkPrefetchWorker&) = delete;
+
+        // Queue `job`. The returned future is set once it has run, or was dropped on shutdown.
+        std::shared_future<void> post(std::function<void()> job)
+        {
+            Job  queued {std::move(job), {}};
+            auto done = queued.done.get_future().share();
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Queue.push_back(std::move(queued));
+            }
+            m_Wake.notify_one();
+            return done;
+        }
+
+    private:
+        struct Job
+        {
+            std::function<void()> run;
+            std::promise<void>    done;
+        };
+
+        void run()
+        {
+            std::unique_lock lock(m_Mutex);
+            while (true)
+            {
+                m_Wake.wait(lock, [this] { return m_Stop || !m_Queue.empty(); });
+                if (m_Stop)
+                    break;
+
+                Job job = std::move(m_Queue.front());
+                m_Queue.pop_front();
+                lock.unlock();
+                job.run();
+                job.done.set_value();
+                lock.lock();
+            }
+            for (auto& job : m_Queue)
+                job.done.set_value();
+            m_Queue.clear();
+        }
+
+        std::mutex              m_Mutex;
+        std::condition_variable m_Wake;
+        std::deque<Job>         m_Queue;
+        bool                    m_Stop {false};
+        std::thread             m_Thread; // last, so it starts after the state it uses
+    };
+
+    class VpkAccessTrace final
+    {
+    public:
+        static constexpr std::string_view kMagic = "# vpk-trace 1";
+
+        bool open(vbase::StringView path)
+        {
+            m_File.open(std::string(path), std::ios::trunc);
+            m_File << kMagic << '\n';
+            m_Start = std::chrono::steady_clock::now();
+            return static_cast<bool>(m_File);
+        }
+
+        void record(std::string_view path, uint64_t rawSize)
+        {
+            std::lock_guard lock(m_Mutex);
+            const auto      micros =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_Start);
+            m_File << micros.count() << '\t' << rawSize << '\t' << path << '\n';
+        }
+
+    private:
+        std::mutex                            m_Mutex;
+        std::ofstream                         m_File;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    vbase::Result<std::vector<std::string>, AssetError>
+    readVpkAccessTraces(const std::vector<std::string>& tracePaths)
+    {
+        struct Rank
+        {
+            size_t position {0}; // earliest first-open position over all sessions
+            size_t firstSeen {0};
+        };
+
+        std::unordered_map<std::string, Rank> ranks;
+        std::vector<std::string>              paths;
+        for (const auto& tracePath : tracePaths)
+        {
+            std::ifstream in(tracePath);
+            if (!in)
+                return vbase::Result<std::vector<std::string>, AssetError>::err(AssetError::eNotFound);
+
+            std::string line;
+            if (!std::getline(in, line) || line != VpkAccessTrace::kMagic)
+                return vbase::Result<std::vector<std::string>, AssetError>::err(AssetError::eInvalidFormat);
+
+            std::unordered_map<std::string, size_t> session;
+            while (std::getline(in, line))
+            {
+                // <microseconds>\t<raw size>\t<path>; the path may itself contain tabs.
+                const size_t first  = line.find('\t');
+                const size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+                if (second == std::string::npos)
+                    return vbase::Result<std::vector<std::string>, AssetError>::err(AssetError::eInvalidFormat);
+
+                std::string path     = line.substr(second + 1);
+                const auto  position = session.size();
+                if (!session.emplace(path, position).second)
+                    continue;
+
+                auto [it, inserted] = ranks.try_emplace(path, Rank {position, paths.size()});
+                if (inserted)
+                    paths.push_back(std::move(path));
+                else
+                    it->second.position = std::min(it->second.position, position);
+            }
+        }
+
+        std::stable_sort(paths.begin(), paths.end(), [&](const std::string& a, const std::string& b) {
+            const Rank& ra = ranks.at(a);
+            const Rank& rb = ranks.at(b);
+            return ra.position != rb.position ? ra.position < rb.position : ra.firstSeen < rb.firstSeen;
+        });
+        return vbase::Result<std::vector<std::string>, AssetError>::ok(std::move(paths));
+    }
+
+    VpkFileSystem::VpkFileSystem(std::string vpkPath, VpkFileSystemOptions options) :
+        m_Path(std::move(vpkPath)), m_Options(options)
+    {}
+
+    VpkFileSystem::VpkFileSystem(std::vector<std::byte> blob, VpkFileSystemOptions options) : m_Options(options)
+    {
+        auto owned   = std::make_shared<const std::vector<std::byte>>(std::move(blob));
+        m_Image      = vbase::ConstByteSpan {owned->data(), owned->size()};
+        m_ImageOwner = std::move(owned);
+    }
 
     vbase::Result<void, AssetError> VpkFileSystem::openPackage()
     {
-        auto r = m_Memory ? openVpkFromMemory(vbase::ConstByteSpan {m_Blob.data(), m_Blob.size()}) : openVpk(m_Path);
+        if (!m_ImageOwner && m_Options.memoryMap)
+        {
+            auto mapped = mapVpk(m_Path);
+            if (!mapped)
+                return vbase::Result<void, AssetError>::err(mapped.error());
+            m_Image      = mapped.value()->bytes();
+            m_ImageOwner = std::move(mapped).value();
+        }
+
+        auto r = m_ImageOwner ? openVpkFromImage(m_ImageOwner, m_Image) : openVpk(m_Path);
         if (!r)
             return vbase::Result<void, AssetError>::err(r.error());
-        m_Pkg   = std::move(r.value());
-        m_Ready = true;
+
+        // A multi-volume pack keeps its payloads outside the image. A blob has no volumes to read from,
+        // so it is refused (and kept as it was); a mapping is dropped and the pack reopened so payloads
+        // are read through the volume handles.
+        if ((r.value().header.flags & kVpkFlagVolumes) && m_ImageOwner)
+        {
+            if (m_Path.empty())
+                return vbase::Result<void, AssetError>::err(AssetError::eNotSupported);
+
+            auto reopened = openVpk(m_Path);
+            if (!reopened)
+                return vbase::Result<void, AssetError>::err(reopened.error());
+            m_Pkg        = std::move(reopened.value());
+            m_Image      = {};
+            m_ImageOwner = nullptr;
+        }
+        else
+        {
+            m_Pkg = std::move(r.value());
+        }
+
+        m_Pkg.verifyOnRead = m_Options.verifyOnRead;
+        m_Ready            = true;
+
+        // Cache keys are payload offsets of this package, so a (re)opened package starts with a fresh cache.
+        m_Cache = m_Options.cacheBudget > 0 ? std::make_shared<VpkEntryCache>(m_Options.cacheBudget) : nullptr;
         return vbase::Result<void, AssetError>::ok();
     }
 
-    bool VpkFileSystem::exists(vbase::StringView p) const
+    namespace
     {
-        if (!m_Ready)
+        // Decode the entries at `positions` of `pkg` into `cache`, skipping those already cached.
+        void warmEntryCache(std::shared_ptr<VpkEntryCache> cache,
+                            VpkReadOnly                    pkg,
+                            std::shared_ptr<const void>    imageOwner,
+                            vbase::ConstByteSpan           image,
+                            std::string                    path,
+                            std::vector<size_t>            positions)
+        {
+            for (const size_t i : positions)
+            {
+                const VpkEntry& e = pkg.entries[i];
+                if (cache->contains(VpkEntryCache::keyOf(e)))
+                    continue;
+                auto r = imageOwner ? detail::readEntryFromMemory(pkg, e, image) : detail::readEntry(pkg, path, e);
+                if (r)
+                    cache->insert(VpkEntryCache::keyOf(e), std::move(r.value()));
+            }
+        }
+    } // namespace
+
+    bool VpkFileSystem::cachesEntry(const VpkEntry& e) const
+    {
+        if (!m_Cache || e.packedSize == 0 || e.rawSize > m_Cache->budget())
+            return false;
+
+        // Mirrors open(): these are borrowed, read frame by frame or streamed instead.
+        const bool canStream = m_ImageOwner || m_Pkg.file;
+        if (m_ImageOwner && e.compression == VpkCompression::eNone)
+            return false;
+        if (canStream && e.compression == VpkCompression::eZstdFrames)
             return false;
-        auto r = m_Memory ? readVpkFileFromMemory(m_Pkg, vbase::ConstByteSpan {m_Blob.data(), m_Blob.size()}, p) :
-                            readVpkFile(m_Pkg, m_Path, p);
-        return static_cast<bool>(r);
+        return !(canStream && m_Options.streamingThreshold > 0 && e.rawSize >= m_Options.streamingThreshold &&
+                 (e.compression == VpkCompression::eZstd || e.compression == VpkCompression::eNone));
+    }
+
+    VpkPrefetchResult VpkFileSystem::prefetch(const vbase::UUID& root, uint32_t depth)
+    {
+        VpkPrefetchResult result;
+        if (!m_Ready)
+            return result;
+
+        std::vector<size_t> decode; // m_Pkg.entries positions to warm the cache with
+        for (const uint32_t r : collectVpkDependencies(m_Pkg, root, depth))
+        {
+            const VpkEntry* e = findVpkEntryByUuid(m_Pkg, m_Pkg.registry[r].uuid);
+            if (!e)
+                continue;
+
+            ++result.entries;
+            result.bytes += e->packedSize;
+            if (m_ImageOwner)
+            {
+                if (e->dataOffset <= m_Image.size() && e->packedSize <= m_Image.size() - e->dataOffset)
+                    detail::willNeed(
+                        m_Image.subspan(static_cast<size_t>(e->dataOffset), static_cast<size_t>(e->packedSize)));
+            }
+            else if (auto file = detail::payloadFile(m_Pkg, *e))
+            {
+                file->willNeed(e->dataOffset, e->packedSize);
+            }
+
+            if (cachesEntry(*e))
+                decode.push_back(static_cast<size_t>(e - m_Pkg.entries.data()));
+        }
+        if (decode.empty())
+            return result;
+
+        // Decoded on this filesystem's single prefetch thread, so dropping the result never waits (a
+        // std::async future would) and requests never pile up threads. The job holds its own
+        // references to the package, so a reopen does not pull it out from under the job.
+        if (!m_Prefetch)
+            m_Prefetch = std::make_shared<VpkPrefetchWorker>();
+        result.decoded = m_Prefetch->post([cache      = m_Cache,
+                                           pkg        = m_Pkg,
+                                           imageOwner = m_ImageOwner,
+                                           image      = m_Image,
+                                           path       = m_Path,
+                                           positions  = std::move(decode)]() mutable {
+            warmEntryCache(
+                std::move(cache), std::move(pkg), std::move(imageOwner), image, std::move(path), std::move(positions));
+        });
+        return result;
+    }
+
+    VpkCacheStats VpkFileSystem::cacheStats() const { return m_Cache ? m_Cache->stats() : VpkCacheStats {}; }
+
+    void VpkFileSystem::clearCache()
+    {
+        if (m_Cache)
+            m_Cache->clear();
+    }
+
+    vbase::Result<void, AssetError> VpkFileSystem::beginTrace(vbase::StringView tracePath)
+    {
+        auto trace = std::make_shared<VpkAccessTrace>();
+        if (!trace->open(tracePath))
+            return vbase::Result<void, AssetError>::err(AssetError::eIOError);
+        m_Trace = std::move(trace);
+        return vbase::Result<void, AssetError>::ok();
+    }
+
+    void VpkFileSystem::endTrace() { m_Trace.reset(); }
+
+    bool VpkFileSystem::exists(vbase::StringView p) const
+    {
+        return m_Ready && findVpkEntry(m_Pkg, p) != nullptr;
     }
 
     bool VpkFileSystem::isFile(vbase::StringView p) const { return exists(p); }
 
-    bool VpkFileSystem::isDirectory(vbase::StringView) const { return false; }
+    bool VpkFileSystem::isDirectory(vbase::StringView p) const { return m_Ready && isVpkDirectory(m_Pkg, p); }
+
+    vbase::Result<std::vector<VpkListEntry>, AssetError> VpkFileSystem::listDirectory(vbase::StringView p) const
+    {
+        if (!m_Ready)
+            return vbase::Result<std::vector<VpkListEntry>, AssetError>::err(AssetError::eNotFound);
+        return listVpkDirectory(m_Pkg, p);
+    }
+
+    vbase::Result<VpkFileStat, AssetError> VpkFileSystem::stat(vbase::StringView p) const
+    {
+        if (!m_Ready)
+            return vbase::Result<VpkFileStat, AssetError>::err(AssetError::eNotFound);
+        return statVpkFile(m_Pkg, p);
+    }
+
+    vbase::Result<vbase::ConstByteSpan, AssetError> VpkFileSystem::view(vbase::StringView p) const
+    {
+        if (!m_Ready || !m_ImageOwner)
+            return vbase::Result<vbase::ConstByteSpan, AssetError>::err(AssetError::eNotSupported);
+        return viewVpkFileFromMemory(m_Pkg, m_Image, p);
+    }
+
+    vbase::Result<vbase::ConstByteSpan, AssetError> VpkFileSystem::viewEntry(const VpkEntry& e) const
+    {
+        if (!m_Ready || !m_ImageOwner)
+            return vbase::Result<vbase::ConstByteSpan, AssetError>::err(AssetError::eNotSupported);
+        return detail::viewEntryFromMemory(m_Pkg, e, m_Image);
+    }
 
     vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
     VpkFileSystem::open(vbase::StringView p, vfilesystem::FileMode mode)
@@ -91,8 +886,83 @@ namespace vasset
             return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
                 vfilesystem::FsError::eIOError);
 
-        auto r = m_Memory ? readVpkFileFromMemory(m_Pkg, vbase::ConstByteSpan {m_Blob.data(), m_Blob.size()}, p) :
-                            readVpkFile(m_Pkg, m_Path, p);
+        const VpkEntry* e = findVpkEntry(m_Pkg, p);
+        if (!e)
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eNotFound);
+
+        return openEntry(*e);
+    }
+
+    vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
+    VpkFileSystem::open(const vbase::UUID& uuid)
+    {
+        if (!m_Ready)
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eIOError);
+
+        const VpkEntry* e = findVpkEntryByUuid(m_Pkg, uuid);
+        if (!e)
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eNotFound);
+
+        return openEntry(*e);
+    }
+
+    vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
+    VpkFileSystem::openEntry(const VpkEntry& e)
+    {
+        // Only opens that succeed are traced.
+        auto opened = [&](std::unique_ptr<vfilesystem::IFile> file) {
+            if (m_Trace)
+            {
+                std::string scratch;
+                m_Trace->record(vpkPathOf(m_Pkg, e, scratch), e.rawSize);
+            }
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::ok(std::move(file));
+        };
+
+        // Uncompressed entries of an in-memory image are borrowed as-is: no read, no copy.
+        if (m_ImageOwner && e.compression == VpkCompression::eNone && e.dataOffset <= m_Image.size() &&
+            e.packedSize <= m_Image.size() - e.dataOffset)
+        {
+            return opened(std::make_unique<VpkBorrowedFile>(
+                m_ImageOwner, m_Image.subspan(static_cast<size_t>(e.dataOffset), static_cast<size_t>(e.packedSize))));
+        }
+
+        // Large entries are decoded on demand instead of being inflated up front.
+        const bool        canStream = m_ImageOwner || m_Pkg.file;
+        const ZSTD_DDict* ddict     = nullptr;
+        if (!detail::entryDDict(m_Pkg, e, ddict))
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eIOError);
+
+        const VpkPackedSource source {detail::payloadFile(m_Pkg, e), m_ImageOwner, m_Image, m_Pkg.dictionaries};
+        if (canStream && e.compression == VpkCompression::eZstdFrames)
+        {
+            auto framed = VpkFramedFile::open(e, source, ddict);
+            if (!framed)
+                return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                    vfilesystem::FsError::eIOError);
+            return opened(std::move(framed));
+        }
+        if (canStream && m_Options.streamingThreshold > 0 && e.rawSize >= m_Options.streamingThreshold &&
+            (e.compression == VpkCompression::eZstd || e.compression == VpkCompression::eNone))
+        {
+            return opened(std::make_unique<VpkStreamingFile>(e, source, ddict));
+        }
+
+        const bool cacheable = cachesEntry(e);
+        if (cacheable)
+        {
+            if (auto cached = m_Cache->find(VpkEntryCache::keyOf(e)))
+            {
+                const vbase::ConstByteSpan bytes {cached->data(), cached->size()};
+                return opened(std::make_unique<VpkBorrowedFile>(std::move(cached), bytes));
+            }
+        }
+
+        auto r = m_ImageOwner ? detail::readEntryFromMemory(m_Pkg, e, m_Image) : detail::readEntry(m_Pkg, m_Path, e);
         if (!r)
         {
             if (r.error() == AssetError::eNotFound)
@@ -102,8 +972,359 @@ namespace vasset
                 vfilesystem::FsError::eIOError);
         }
 
-        return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::ok(
-            std::make_unique<VpkMemoryFile>(std::move(r.value())));
+        if (cacheable)
+        {
+            auto                       cached = m_Cache->insert(VpkEntryCache::keyOf(e), std::move(r.value()));
+            const vbase::ConstByteSpan bytes {cached->data(), cached->size()};
+            return opened(std::make_unique<VpkBorrowedFile>(std::move(cached), bytes));
+        }
+
+        return opened(std::make_unique<VpkMemoryFile>(std::move(r.value())));
+    }
+
+    void VpkOverlayFileSystem::mount(std::shared_ptr<VpkFileSystem> layer)
+    {
+        if (layer)
+            m_Layers.push_back(std::move(layer));
+    }
+
+    VpkFileSystem* VpkOverlayFileSystem::resolve(vbase::StringView p) const
+    {
+        for (auto it = m_Layers.rbegin(); it != m_Layers.rend(); ++it)
+        {
+            const VpkEntry* e = findVpkEntryOrTombstone((*it)->getVpk(), p);
+            if (!e)
+                continue;
+            return (e->flags & kVpkEntryFlagTombstone) ? nullptr : it->get();
+        }
+        return nullptr;
+    }
+
+    bool VpkOverlayFileSystem::exists(vbase::StringView p) const { return resolve(p) != nullptr; }
+
+    bool VpkOverlayFileSystem::isFile(vbase::StringView p) const { return exists(p); }
+
+    bool VpkOverlayFileSystem::isDirectory(vbase::StringView p) const
+    {
+        return std::any_of(m_Layers.begin(), m_Layers.end(), [&](const auto& layer) { return layer->isDirectory(p); });
+    }
+
+    vbase::Result<VpkFileStat, AssetError> VpkOverlayFileSystem::stat(vbase::StringView p) const
+    {
+        VpkFileSystem* layer = resolve(p);
+        if (!layer)
+            return vbase::Result<VpkFileStat, AssetError>::err(AssetError::eNotFound);
+        return layer->stat(p);
+    }
+
+    vbase::Result<std::vector<VpkListEntry>, AssetError> VpkOverlayFileSystem::listDirectory(vbase::StringView p) const
+    {
+        std::string_view dir(p.data(), p.size());
+        while (!dir.empty() && dir.front() == '/')
+            dir.remove_prefix(1);
+        while (!dir.empty() && dir.back() == '/')
+            dir.remove_suffix(1);
+
+        std::map<std::string_view, VpkListEntry> dirs;
+        std::map<std::string_view, VpkListEntry> files;
+        bool                                     found = false;
+        std::string                              full;
+        for (auto it = m_Layers.rbegin(); it != m_Layers.rend(); ++it)
+        {
+            auto children = (*it)->listDirectory(p);
+            if (!children)
+                continue;
+            found = true;
+            for (const auto& child : children.value())
+            {
+                if (child.isDirectory)
+                {
+                    dirs.emplace(child.name, child);
+                    continue;
+                }
+                // Only the layer that resolves the full path reports it; that drops shadowed copies
+                // and files a higher layer has tombstoned.
+                full.assign(dir);
+                if (!full.empty())
+                    full.push_back('/');
+                full.append(child.name);
+                if (!files.contains(child.name) && resolve(full) == it->get())
+                    files.emplace(child.name, child);
+            }
+        }
+        if (!found)
+            return vbase::Result<std::vector<VpkListEntry>, AssetError>::err(AssetError::eNotFound);
+
+        std::vector<VpkListEntry> out;
+        out.reserve(dirs.size() + files.size());
+        for (const auto& [name, child] : dirs)
+            out.push_back(child);
+        for (const auto& [name, child] : files)
+            out.push_back(child);
+        return vbase::Result<std::vector<VpkListEntry>, AssetError>::ok(std::move(out));
+    }
+
+    vbase::Result<vbase::ConstByteSpan, AssetError> VpkOverlayFileSystem::view(vbase::StringView p) const
+    {
+        VpkFileSystem* layer = resolve(p);
+        if (!layer)
+            return vbase::Result<vbase::ConstByteSpan, AssetError>::err(AssetError::eNotFound);
+        return layer->view(p);
+    }
+
+    vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
+    VpkOverlayFileSystem::open(vbase::StringView p, vfilesystem::FileMode mode)
+    {
+        if (mode != vfilesystem::FileMode::eRead)
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eNotSupported);
+
+        VpkFileSystem* layer = resolve(p);
+        if (!layer)
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eNotFound);
+        return layer->open(p, mode);
+    }
+
+    struct VpkMultiIndex
+    {
+        // Split-block Bloom filter over 64-bit path hashes: the high half picks a 256-bit block, the
+        // low half sets one bit in each of its eight words, so a query reads a single cache line.
+        class PathFilter
+        {
+        public:
+            explicit PathFilter(size_t keys = 0)
+            {
+                constexpr size_t kBitsPerKey = 16; // ~0.1% false positives
+                m_Blocks = std::bit_ceil(std::max<size_t>(1, (keys * kBitsPerKey + 255) / 256));
+                m_Words.assign(m_Blocks * 8, 0);
+            }
+
+            void insert(uint64_t hash)
+            {
+                uint32_t* block = m_Words.data() + blockOf(hash) * 8;
+                for (size_t i = 0; i < 8; ++i)
+                    block[i] |= bitOf(hash, i);
+            }
+
+            bool mayContain(uint64_t hash) const
+            {
+                const uint32_t* block = m_Words.data() + blockOf(hash) * 8;
+                for (size_t i = 0; i < 8; ++i)
+                    if ((block[i] & bitOf(hash, i)) == 0)
+                        return false;
+                return true;
+            }
+
+        private:
+            static constexpr std::array<uint32_t, 8> kSalts {
+                0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+            size_t blockOf(uint64_t hash) const { return static_cast<size_t>(hash >> 32) & (m_Blocks - 1); }
+
+            static uint32_t bitOf(uint64_t hash, size_t i)
+            {
+                return 1u << ((static_cast<uint32_t>(hash) * kSalts[i]) >> 27);
+            }
+
+            size_t                m_Blocks {1};
+            std::vector<uint32_t> m_Words;
+        };
+
+        struct Mount
+        {
+            std::shared_ptr<VpkFileSystem> pack;
+            int                            priority {0};
+            PathFilter                     filter; // every path of the pack, tombstones included
+        };
+
+        // A visible path: entry `entry` of mount `mount`.
+        struct Slot
+        {
+            uint64_t hash {0};
+            uint32_t mount {0};
+            uint32_t entry {0};
+        };
+
+        std::vector<Mount>    mounts; // in mount order
+        std::vector<uint32_t> order;  // mount indices, highest priority first
+        std::vector<Slot>     slots;  // sorted by hash
+        PathFilter            filter; // hashes of `slots`
+
+        void rebuild()
+        {
+            order.resize(mounts.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return mounts[a].priority != mounts[b].priority ? mounts[a].priority > mounts[b].priority : a > b;
+            });
+
+            // Walk mounts from the top; a path is visible from the first mount holding it, unless that
+            // holds a tombstone. Mounts above are only searched when their filter admits the hash.
+            slots.clear();
+            for (size_t rank = 0; rank < order.size(); ++rank)
+            {
+                const VpkReadOnly& vpk = mounts[order[rank]].pack->getVpk();
+                std::string        scratch;
+                for (size_t i = 0; i < vpk.entries.size(); ++i)
+                {
+                    const VpkEntry& e = vpk.entries[i];
+                    if (e.flags & kVpkEntryFlagTombstone)
+                        continue;
+                    const std::string_view path = vpkPathOf(vpk, e, scratch);
+                    if (path.size() != e.pathSize)
+                        continue;
+
+                    bool hidden = false;
+                    for (size_t above = 0; above < rank && !hidden; ++above)
+                    {
+                        const Mount& m = mounts[order[above]];
+                        hidden = m.filter.mayContain(e.pathHash64) && findVpkEntryOrTombstone(m.pack->getVpk(), path);
+                    }
+                    if (!hidden)
+                        slots.push_back(Slot {e.pathHash64, order[rank], static_cast<uint32_t>(i)});
+                }
+            }
+
+            std::sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) {
+                return a.hash != b.hash ? a.hash < b.hash : a.mount != b.mount ? a.mount < b.mount : a.entry < b.entry;
+            });
+            filter = PathFilter(slots.size());
+            for (const auto& slot : slots)
+                filter.insert(slot.hash);
+        }
+    };
+
+    VpkMultiFileSystem::VpkMultiFileSystem() : m_Index(std::make_unique<VpkMultiIndex>()) {}
+
+    VpkMultiFileSystem::~VpkMultiFileSystem() = default;
+
+    void VpkMultiFileSystem::mount(std::shared_ptr<VpkFileSystem> pack, int priority)
+    {
+        if (!pack)
+            return;
+
+        const VpkReadOnly&        vpk = pack->getVpk();
+        VpkMultiIndex::PathFilter filter(vpk.entries.size());
+        for (const auto& e : vpk.entries)
+            filter.insert(e.pathHash64);
+
+        m_Index->mounts.push_back(VpkMultiIndex::Mount {std::move(pack), priority, std::move(filter)});
+        m_Index->rebuild();
+    }
+
+    size_t VpkMultiFileSystem::mountCount() const { return m_Index->mounts.size(); }
+
+    size_t VpkMultiFileSystem::fileCount() const { return m_Index->slots.size(); }
+
+    std::pair<VpkFileSystem*, const VpkEntry*> VpkMultiFileSystem::resolve(vbase::StringView p) const
+    {
+        std::string_view path(p.data(), p.size());
+        if (!path.empty() && path.front() == '/')
+            path.remove_prefix(1);
+
+        const uint64_t hash = XXH3_64bits(path.data(), path.size());
+        if (!m_Index->filter.mayContain(hash))
+            return {nullptr, nullptr};
+
+        const auto& slots = m_Index->slots;
+        auto        it    = std::lower_bound(
+            slots.begin(), slots.end(), hash, [](const VpkMultiIndex::Slot& s, uint64_t h) { return s.hash < h; });
+        for (; it != slots.end() && it->hash == hash; ++it)
+        {
+            VpkFileSystem*     pack = m_Index->mounts[it->mount].pack.get();
+            const VpkReadOnly& vpk  = pack->getVpk();
+            const VpkEntry&    e    = vpk.entries[it->entry];
+            if (detail::pathMatches(vpk, e.pathOffset, e.pathSize, path))
+                return {pack, &e};
+        }
+        return {nullptr, nullptr};
+    }
+
+    bool VpkMultiFileSystem::exists(vbase::StringView p) const { return resolve(p).first != nullptr; }
+
+    bool VpkMultiFileSystem::isFile(vbase::StringView p) const { return exists(p); }
+
+    bool VpkMultiFileSystem::isDirectory(vbase::StringView p) const
+    {
+        const auto& mounts = m_Index->mounts;
+        return std::any_of(mounts.begin(), mounts.end(), [&](const auto& m) { return m.pack->isDirectory(p); });
+    }
+
+    vbase::Result<VpkFileStat, AssetError> VpkMultiFileSystem::stat(vbase::StringView p) const
+    {
+        const auto [pack, e] = resolve(p);
+        if (!pack)
+            return vbase::Result<VpkFileStat, AssetError>::err(AssetError::eNotFound);
+        return vbase::Result<VpkFileStat, AssetError>::ok(detail::entryStat(*e));
+    }
+
+    vbase::Result<std::vector<VpkListEntry>, AssetError> VpkMultiFileSystem::listDirectory(vbase::StringView p) const
+    {
+        std::string_view dir(p.data(), p.size());
+        while (!dir.empty() && dir.front() == '/')
+            dir.remove_prefix(1);
+        while (!dir.empty() && dir.back() == '/')
+            dir.remove_suffix(1);
+
+        std::map<std::string_view, VpkListEntry> dirs;
+        std::map<std::string_view, VpkListEntry> files;
+        bool                                     found = false;
+        std::string                              full;
+        for (const uint32_t m : m_Index->order)
+        {
+            VpkFileSystem* pack     = m_Index->mounts[m].pack.get();
+            auto           children = pack->listDirectory(p);
+            if (!children)
+                continue;
+            found = true;
+            for (const auto& child : children.value())
+            {
+                if (child.isDirectory)
+                {
+                    dirs.emplace(child.name, child);
+                    continue;
+                }
+                full.assign(dir);
+                if (!full.empty())
+                    full.push_back('/');
+                full.append(child.name);
+                if (!files.contains(child.name) && resolve(full).first == pack)
+                    files.emplace(child.name, child);
+            }
+        }
+        if (!found)
+            return vbase::Result<std::vector<VpkListEntry>, AssetError>::err(AssetError::eNotFound);
+
+        std::vector<VpkListEntry> out;
+        out.reserve(dirs.size() + files.size());
+        for (const auto& [name, child] : dirs)
+            out.push_back(child);
+        for (const auto& [name, child] : files)
+            out.push_back(child);
+        return vbase::Result<std::vector<VpkListEntry>, AssetError>::ok(std::move(out));
+    }
+
+    vbase::Result<vbase::ConstByteSpan, AssetError> VpkMultiFileSystem::view(vbase::StringView p) const
+    {
+        const auto [pack, e] = resolve(p);
+        if (!pack)
+            return vbase::Result<vbase::ConstByteSpan, AssetError>::err(AssetError::eNotFound);
+        return pack->viewEntry(*e);
+    }
+
+    vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>
+    VpkMultiFileSystem::open(vbase::StringView p, vfilesystem::FileMode mode)
+    {
+        if (mode != vfilesystem::FileMode::eRead)
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eNotSupported);
+
+        const auto [pack, e] = resolve(p);
+        if (!pack)
+            return vbase::Result<std::unique_ptr<vfilesystem::IFile>, vfilesystem::FsError>::err(
+                vfilesystem::FsError::eNotFound);
+        return pack->openEntry(*e);
     }
 
 } // namespace vasset
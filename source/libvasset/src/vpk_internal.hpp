@@ -0,0 +1,227 @@
+// Internal (not installed) VPK plumbing shared by the reader (vpk.cpp), the filesystem
+// (vpk_filesystem.cpp) and the platform I/O layer (vpk_io.cpp).
+#pragma once
+
+#include "vasset/vpk.hpp"
+
+#include <zstd.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vasset
+{
+    // A read-only OS file handle for positional reads (pread / ReadFile+OVERLAPPED). readAt() carries
+    // its own offset, so one handle is shared by any number of threads without a lock.
+    class VpkFileHandle final
+    {
+    public:
+        VpkFileHandle() = default;
+        ~VpkFileHandle();
+
+        VpkFileHandle(const VpkFileHandle&)            = delete;
+        VpkFileHandle& operator=(const VpkFileHandle&) = delete;
+
+        static vbase::Result<std::shared_ptr<const VpkFileHandle>, AssetError> open(vbase::StringView path);
+
+        // Read exactly n bytes at `offset`. False on a short read or I/O error. Thread-safe.
+        bool readAt(uint64_t offset, void* dst, size_t n) const;
+
+        // Ask the OS to start reading [offset, offset + n) into the page cache; returns immediately.
+        // A no-op where the platform has no such hint.
+        void willNeed(uint64_t offset, uint64_t n) const;
+
+        uint64_t size() const { return m_Size; }
+
+    private:
+#if defined(_WIN32)
+        void* m_Handle {nullptr};
+#else
+        int m_Fd {-1};
+#endif
+        uint64_t m_Size {0};
+    };
+
+    namespace detail
+    {
+        struct ZstdDCtxDeleter
+        {
+            void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); }
+        };
+        using ZstdDCtxPtr = std::unique_ptr<ZSTD_DCtx, ZstdDCtxDeleter>;
+
+        struct ZstdDDictDeleter
+        {
+            void operator()(ZSTD_DDict* dict) const { ZSTD_freeDDict(dict); }
+        };
+        using ZstdDDictPtr = std::unique_ptr<ZSTD_DDict, ZstdDDictDeleter>;
+    } // namespace detail
+
+    // The dictionary section of a package, digested into ZSTD_DDicts once at open so every decode
+    // against a dictionary skips re-loading it. Immutable and shared by all readers of the package.
+    class VpkDictionaries final
+    {
+    public:
+        std::vector<VpkDictionaryEntry>   entries;
+        std::vector<detail::ZstdDDictPtr> ddicts; // parallel to entries
+    };
+
+    // Paths of a front-coded package that listings have handed out. Listing names are views that must
+    // outlive the call, so each path is decoded once on first use and kept for the package's lifetime;
+    // paths that are only looked up are never stored. Thread-safe.
+    class VpkPathNames final
+    {
+    public:
+        std::string_view path(const VpkReadOnly& vpk, uint32_t rank, uint32_t size);
+
+    private:
+        std::mutex                                m_Mutex;
+        std::unordered_map<uint32_t, std::string> m_Paths; // by rank; nodes keep the strings in place
+    };
+
+    // The volume files of a multi-volume package, opened on first read. A volume whose file is
+    // missing or does not have the size the package recorded stays unopened. Thread-safe.
+    class VpkVolumes final
+    {
+    public:
+        VpkVolumes(std::string vpkPath, std::span<const uint64_t> sizes);
+
+        // Handle of volume `index`; nullptr when it is out of range or cannot be opened.
+        std::shared_ptr<const VpkFileHandle> handle(uint32_t index) const;
+
+    private:
+        std::string                                               m_Path;
+        std::vector<uint64_t>                                     m_Sizes;
+        mutable std::mutex                                        m_Mutex;
+        mutable std::vector<std::shared_ptr<const VpkFileHandle>> m_Handles;
+    };
+
+    namespace detail
+    {
+        // The handle an entry's payload is read through: the package file, or the entry's volume for
+        // multi-volume packages. nullptr when there is none (memory packs, unreadable volumes).
+        std::shared_ptr<const VpkFileHandle> payloadFile(const VpkReadOnly& vpk, const VpkEntry& e);
+
+        // Whether the path at (pathOffset, pathSize) of an entry or registry record equals `path`.
+        // Front-coded packs decode the candidate's bucket into a per-thread buffer.
+        bool pathMatches(const VpkReadOnly& vpk, uint32_t pathOffset, uint32_t pathSize, std::string_view path);
+
+        // Resolve the dictionary an entry was compressed against: out is nullptr for entries without
+        // one. False when the entry names a dictionary the package does not carry.
+        bool entryDDict(const VpkReadOnly& vpk, const VpkEntry& e, const ZSTD_DDict*& out);
+
+        // Decompress one zstd frame (against `ddict` when non-null). True only when exactly
+        // dstSize bytes come out.
+        bool decompressFrame(ZSTD_DCtx*        dctx,
+                             const ZSTD_DDict* ddict,
+                             void*             dst,
+                             size_t            dstSize,
+                             const void*       src,
+                             size_t            srcSize);
+
+        // Ask the OS to fault in the pages under `bytes` (part of a mapping or of ordinary memory)
+        // ahead of use; returns immediately.
+        void willNeed(vbase::ConstByteSpan bytes);
+
+        // The calling thread's zstd decompression context, created on first use and reused for every
+        // later decode on that thread (one-shot ZSTD_decompress allocates a fresh context per call).
+        ZSTD_DCtx* threadDCtx();
+
+        // A transient byte buffer borrowed from the calling thread's pool. Buffers are kept in
+        // power-of-two size classes and handed back on destruction, so the packed reads of a
+        // streaming thread stop reaching the allocator once it has warmed up. Requests beyond the
+        // largest class get a plain allocation that is freed on release.
+        class ScratchBuffer final
+        {
+        public:
+            explicit ScratchBuffer(size_t size);
+            ~ScratchBuffer();
+
+            ScratchBuffer(const ScratchBuffer&)            = delete;
+            ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+            std::byte*           data() { return m_Bytes.data(); }
+            size_t               size() const { return m_Size; }
+            vbase::ConstByteSpan span() const { return {m_Bytes.data(), m_Size}; }
+
+        private:
+            std::vector<std::byte> m_Bytes; // capacity is the size class; size() may exceed m_Size
+            size_t                 m_Size {0};
+        };
+
+        // Seek table of an eZstdFrames entry. The packed payload is laid out as
+        //   [u32 frameRawSize][u32 frameCount][u64 frameEnd[frameCount]][frame 0]...[frame N-1]
+        // where frameEnd[i] is the end of frame i relative to the first frame. Every frame but the
+        // last holds exactly frameRawSize raw bytes.
+        struct VpkFrameTable
+        {
+            uint32_t              frameRawSize {0};
+            uint64_t              framesOffset {0}; // first frame, relative to the packed payload
+            std::vector<uint64_t> frameEnds;
+
+            size_t   frameCount() const { return frameEnds.size(); }
+            uint64_t packedBegin(size_t i) const { return framesOffset + (i == 0 ? 0 : frameEnds[i - 1]); }
+            uint64_t packedEnd(size_t i) const { return framesOffset + frameEnds[i]; }
+            uint64_t rawBegin(size_t i) const { return static_cast<uint64_t>(i) * frameRawSize; }
+        };
+
+        // Load and validate an entry's frame table. readPacked(offset, dst, n) reads n bytes at
+        // `offset` within the entry's packed payload.
+        template<typename ReadPacked>
+        bool readFrameTable(const VpkEntry& e, ReadPacked&& readPacked, VpkFrameTable& out)
+        {
+            uint32_t head[2] = {};
+            if (e.packedSize < sizeof(head) || !readPacked(0, head, sizeof(head)) || head[0] == 0)
+                return false;
+
+            const uint64_t frameCount = head[1];
+            if (frameCount != (e.rawSize + head[0] - 1) / head[0])
+                return false;
+            if (frameCount > (e.packedSize - sizeof(head)) / sizeof(uint64_t))
+                return false;
+
+            out.frameRawSize = head[0];
+            out.framesOffset = sizeof(head) + frameCount * sizeof(uint64_t);
+            out.frameEnds.resize(static_cast<size_t>(frameCount));
+            if (frameCount > 0 &&
+                !readPacked(sizeof(head), out.frameEnds.data(), out.frameEnds.size() * sizeof(uint64_t)))
+                return false;
+
+            uint64_t prev = 0;
+            for (uint64_t end : out.frameEnds)
+            {
+                if (end < prev)
+                    return false;
+                prev = end;
+            }
+            return out.framesOffset + prev == e.packedSize;
+        }
+
+        // Read + decode one already-located entry (the lookup half of readVpkFile /
+        // readVpkFileFromMemory), so callers holding a VpkEntry don't hash the path twice.
+        vbase::Result<std::vector<std::byte>, AssetError>
+        readEntry(const VpkReadOnly& vpk, vbase::StringView vpkPath, const VpkEntry& e);
+        vbase::Result<std::vector<std::byte>, AssetError>
+        readEntryFromMemory(const VpkReadOnly& vpk, const VpkEntry& e, vbase::ConstByteSpan blob);
+
+        // As above, decoding into `out` (resized to the raw size, capacity reused).
+        vbase::Result<void, AssetError> readEntryInto(const VpkReadOnly&      vpk,
+                                                      vbase::StringView       vpkPath,
+                                                      const VpkEntry&         e,
+                                                      std::vector<std::byte>& out);
+        vbase::Result<void, AssetError> readEntryFromMemoryInto(const VpkReadOnly&      vpk,
+                                                                const VpkEntry&         e,
+                                                                vbase::ConstByteSpan    blob,
+                                                                std::vector<std::byte>& out);
+
+        // The lookup-free halves of statVpkFile and viewVpkFileFromMemory.
+        VpkFileStat entryStat(const VpkEntry& e);
+        vbase::Result<vbase::ConstByteSpan, AssetError>
+        viewEntryFromMemory(const VpkReadOnly& vpk, const VpkEntry& e, vbase::ConstByteSpan blob);
+    } // namespace detail
+} // namespace vasset
@@ -0,0 +1,231 @@
+// Platform file access for VPK packages: read-only memory mapping (mmap / MapViewOfFile) and the
+// shared positional-read handle (pread / ReadFile with an explicit offset).
+#include "vpk_internal.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace vasset
+{
+    VpkMapping::~VpkMapping()
+    {
+#if defined(_WIN32)
+        if (m_Data)
+            UnmapViewOfFile(m_Data);
+        if (m_MappingHandle)
+            CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+#else
+        if (m_Data)
+            munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+    }
+
+    vbase::Result<std::shared_ptr<const VpkMapping>, AssetError> mapVpk(vbase::StringView vpkPath)
+    {
+        using MapResult = vbase::Result<std::shared_ptr<const VpkMapping>, AssetError>;
+
+        auto mapping = std::make_shared<VpkMapping>();
+
+#if defined(_WIN32)
+        const std::filesystem::path osPath(std::string {vpkPath});
+
+        HANDLE file = CreateFileW(osPath.c_str(),
+                                  GENERIC_READ,
+                                  FILE_SHARE_READ,
+                                  nullptr,
+                                  OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+                                  nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return MapResult::err(AssetError::eNotFound);
+
+        LARGE_INTEGER size {};
+        if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+        {
+            CloseHandle(file);
+            return MapResult::err(AssetError::eInvalidFormat);
+        }
+
+        // The mapping object holds its own reference to the file; the file handle can go.
+        HANDLE fileMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!fileMapping)
+            return MapResult::err(AssetError::eIOError);
+
+        const void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+        {
+            CloseHandle(fileMapping);
+            return MapResult::err(AssetError::eIOError);
+        }
+
+        mapping->m_MappingHandle = fileMapping;
+        mapping->m_Data          = static_cast<const std::byte*>(view);
+        mapping->m_Size          = static_cast<size_t>(size.QuadPart);
+#else
+        const int fd = ::open(std::string(vpkPath).c_str(), O_RDONLY);
+        if (fd < 0)
+            return MapResult::err(AssetError::eNotFound);
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            ::close(fd);
+            return MapResult::err(AssetError::eInvalidFormat);
+        }
+
+        // The mapping keeps the file referenced; the descriptor is not needed afterwards.
+        void* view = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return MapResult::err(AssetError::eIOError);
+
+        mapping->m_Data = static_cast<const std::byte*>(view);
+        mapping->m_Size = static_cast<size_t>(st.st_size);
+#endif
+
+        return MapResult::ok(std::move(mapping));
+    }
+
+    VpkFileHandle::~VpkFileHandle()
+    {
+#if defined(_WIN32)
+        if (m_Handle)
+            CloseHandle(static_cast<HANDLE>(m_Handle));
+#else
+        if (m_Fd >= 0)
+            ::close(m_Fd);
+#endif
+    }
+
+    vbase::Result<std::shared_ptr<const VpkFileHandle>, AssetError> VpkFileHandle::open(vbase::StringView path)
+    {
+        using OpenResult = vbase::Result<std::shared_ptr<const VpkFileHandle>, AssetError>;
+
+        auto handle = std::make_shared<VpkFileHandle>();
+
+#if defined(_WIN32)
+        const std::filesystem::path osPath(std::string {path});
+
+        HANDLE file = CreateFileW(osPath.c_str(),
+                                  GENERIC_READ,
+                                  FILE_SHARE_READ,
+                                  nullptr,
+                                  OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+                                  nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return OpenResult::err(AssetError::eNotFound);
+
+        LARGE_INTEGER size {};
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            return OpenResult::err(AssetError::eIOError);
+        }
+
+        handle->m_Handle = file;
+        handle->m_Size   = static_cast<uint64_t>(size.QuadPart);
+#else
+        const int fd = ::open(std::string(path).c_str(), O_RDONLY);
+        if (fd < 0)
+            return OpenResult::err(AssetError::eNotFound);
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return OpenResult::err(AssetError::eIOError);
+        }
+
+        handle->m_Fd   = fd;
+        handle->m_Size = static_cast<uint64_t>(st.st_size);
+#endif
+
+        return OpenResult::ok(std::move(handle));
+    }
+
+    bool VpkFileHandle::readAt(uint64_t offset, void* dst, size_t n) const
+    {
+        if (offset > m_Size || n > m_Size - offset)
+            return false;
+
+        auto* out = static_cast<char*>(dst);
+        while (n > 0)
+        {
+#if defined(_WIN32)
+            // A synchronous handle with an explicit OVERLAPPED offset: each call positions itself,
+            // so concurrent readers never race on a shared file pointer.
+            const DWORD chunk = static_cast<DWORD>(n < 0x40000000u ? n : 0x40000000u);
+            OVERLAPPED  ov {};
+            ov.Offset     = static_cast<DWORD>(offset & 0xFFFFFFFFull);
+            ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+            DWORD got = 0;
+            if (!ReadFile(static_cast<HANDLE>(m_Handle), out, chunk, &got, &ov) || got == 0)
+                return false;
+#else
+            const ssize_t got = ::pread(m_Fd, out, n, static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                return false;
+#endif
+            out += got;
+            offset += static_cast<uint64_t>(got);
+            n -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    void VpkFileHandle::willNeed(uint64_t offset, uint64_t n) const
+    {
+        if (offset >= m_Size || n == 0)
+            return;
+        n = std::min(n, m_Size - offset);
+#if defined(__APPLE__)
+        radvisory advice {};
+        advice.ra_offset = static_cast<off_t>(offset);
+        advice.ra_count  = static_cast<int>(std::min<uint64_t>(n, INT32_MAX));
+        ::fcntl(m_Fd, F_RDADVISE, &advice);
+#elif !defined(_WIN32)
+        ::posix_fadvise(m_Fd, static_cast<off_t>(offset), static_cast<off_t>(n), POSIX_FADV_WILLNEED);
+#endif
+    }
+
+    namespace detail
+    {
+        void willNeed(vbase::ConstByteSpan bytes)
+        {
+            if (bytes.empty())
+                return;
+#if defined(_WIN32)
+            WIN32_MEMORY_RANGE_ENTRY range {const_cast<std::byte*>(bytes.data()), bytes.size()};
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+            // madvise wants a page-aligned start.
+            const auto page  = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+            const auto begin = reinterpret_cast<uintptr_t>(bytes.data()) & ~(page - 1);
+            const auto end   = reinterpret_cast<uintptr_t>(bytes.data()) + bytes.size();
+            ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#endif
+        }
+    } // namespace detail
+} // namespace vasset
@@ -1,4 +1,4 @@
-add_requires("glm", "stb", "xxhash", "meshoptimizer", "tinyexr", "zstd")
+add_requires("glm", "stb", "xxhash", "meshoptimizer", "tinyexr", "zstd", "lz4")
 add_requires("vfilesystem") -- consumed from xmake-repo (was an external/ submodule)
 add_requires("miniaudio 0.11.25")
 local enable_import_targets = not is_plat("android") and (not is_plat("wasm") or has_config("vasset_enable_wasm_import"))
@@ -76,11 +76,11 @@ target("vasset")
     end
     add_includedirs("include", {public = true})
     add_headerfiles(table.unpack(runtime_headers))
-    add_files("src/vasset_registry.cpp", "src/vgaussiansplat.cpp", "src/vanimation.cpp", "src/vaudio.cpp", "src/vfont.cpp", "src/miniaudio_impl.cpp", "src/vmesh.cpp", "src/vpk.cpp", "src/vpk_filesystem.cpp",
+    add_files("src/vasset_registry.cpp", "src/vgaussiansplat.cpp", "src/vanimation.cpp", "src/vaudio.cpp", "src/vfont.cpp", "src/miniaudio_impl.cpp", "src/vmesh.cpp", "src/vpk.cpp", "src/vpk_filesystem.cpp", "src/vpk_io.cpp",
               "src/vtexture.cpp", "src/vasset_c_api_runtime.cpp")
     add_deps("dds-ktx", {public = true})
     add_packages("vfilesystem", {public = true}) -- published package (was a submodule target)
-    add_packages("glm", "stb", "xxhash", "meshoptimizer", "tinyexr", "zstd", { public = true })
+    add_packages("glm", "stb", "xxhash", "meshoptimizer", "tinyexr", "zstd", "lz4", { public = true })
     add_packages("miniaudio", { public = true })
     add_packages("ktx", { public = true })
     if enable_ktx_opencl then
@@ -267,6 +267,58 @@ TEST(AssetPack, RootClosureExcludesUnusedAssets)
     fs::remove_all(root);
 }
 
+TEST(AssetPack, DependenciesAreLaidOutAfterTheirOwner)
+{
+    namespace fs = std::filesystem;
+
+    const fs::path root = fs::temp_directory_path() / "vasset_pack_dependency_layout";
+    fs::remove_all(root);
+    fs::create_directories(root / "scenes");
+    fs::create_directories(root / "scripts");
+    fs::create_directories(root / "imported");
+
+    VAssetRegistry registry {};
+    registry.setAssetRootPath(root.generic_string());
+    registry.setImportedFolderName("imported");
+
+    const auto sceneUuid = vbase::uuid_from_string_key("imported/Scene/main");
+    ASSERT_TRUE(registry.registerAsset(sceneUuid, "scenes/main.vscn", "imported/Scene/main", VAssetType::eScene));
+    std::ofstream(root / "scenes" / "main.vscn") << "scene\n";
+
+    std::vector<VAssetDependency> sceneDeps;
+    for (const char* name : {"c", "a", "b", "z"})
+    {
+        const std::string source = std::string("scripts/") + name + ".lua";
+        const auto        uuid   = vbase::uuid_from_string_key(std::string("imported/ScriptLua/") + name);
+        std::ofstream(root / source) << "return \"" << name << "\"\n";
+        ASSERT_TRUE(registry.registerAsset(uuid, source, std::string("imported/ScriptLua/") + name,
+                                           VAssetType::eScriptLua));
+        if (std::string_view(name) != "z")
+            sceneDeps.push_back(VAssetDependency {.kind = VAssetDependencyKind::eSceneComponent, .targetUuid = uuid});
+    }
+    registry.setDependencies(sceneUuid, sceneDeps);
+    ASSERT_TRUE(registry.save((root / "imported" / "asset_registry.tsv").generic_string()));
+
+    const auto outVpk = root / "resources.vpk";
+    ASSERT_TRUE(packAssetFolderToVpk(root.generic_string(), outVpk.generic_string()));
+
+    auto opened = openVpk(outVpk.generic_string());
+    ASSERT_TRUE(opened);
+    std::vector<std::string> layout;
+    for (const char* path : {"scenes/main.vscn", "scripts/a.lua", "scripts/b.lua", "scripts/c.lua", "scripts/z.lua"})
+        layout.push_back(path);
+    std::sort(layout.begin(), layout.end(), [&](const std::string& a, const std::string& b) {
+        return findVpkEntry(opened.value(), a)->dataOffset < findVpkEntry(opened.value(), b)->dataOffset;
+    });
+
+    // The scene, then its dependencies in the order it lists them, then the unreferenced script.
+    EXPECT_EQ(layout,
+              (std::vector<std::string> {
+                  "scenes/main.vscn", "scripts/c.lua", "scripts/a.lua", "scripts/b.lua", "scripts/z.lua"}));
+
+    fs::remove_all(root);
+}
+
 TEST(MeshSerialization, SkinMetadataRoundTrip)
 {
     VMesh mesh {};
@@ -171,6 +171,44 @@ TEST(VassetCApi, VpkReadRoundTrip)
     EXPECT_EQ(blob.data[2], '!');
     vasset_blob_free(&blob);
 
+    ASSERT_EQ(vasset_vpk_read_uuid(vpk, vbase::to_string(item.uuid).c_str(), &blob), VASSET_OK);
+    ASSERT_EQ(blob.size, payload.size());
+    EXPECT_EQ(blob.data[1], 'i');
+    vasset_blob_free(&blob);
+    EXPECT_EQ(vasset_vpk_read_uuid(vpk, uuidHex(1, 2).c_str(), &blob), -VASSET_ERR_NOT_FOUND);
+    EXPECT_EQ(vasset_vpk_read_uuid(vpk, "not-a-uuid", &blob), -VASSET_ERR_INVALID_ARG);
+
+    uint64_t rawSize     = 0;
+    int32_t  compression = -1;
+    ASSERT_EQ(vasset_vpk_stat(vpk, "res://a.bin", &rawSize, nullptr, &compression), VASSET_OK);
+    EXPECT_EQ(rawSize, payload.size());
+    EXPECT_EQ(compression, 0); // allowCompress = false -> stored
+    EXPECT_LT(vasset_vpk_stat(vpk, "res://missing.bin", nullptr, nullptr, nullptr), 0);
+
+    const char* batchPaths[] = {"res://a.bin", "res://missing.bin", "res://a.bin"};
+    VAssetBlob  batch[3]     = {};
+    int32_t     status[3]    = {};
+    EXPECT_LT(vasset_vpk_read_batch(vpk, batchPaths, 3, batch, status), 0);
+    EXPECT_EQ(status[0], VASSET_OK);
+    EXPECT_EQ(status[1], -VASSET_ERR_NOT_FOUND);
+    EXPECT_EQ(status[2], VASSET_OK);
+    ASSERT_EQ(batch[2].size, payload.size());
+    EXPECT_EQ(batch[2].data[1], 'i');
+    EXPECT_EQ(batch[1].data, nullptr);
+    vasset_blob_free(&batch[0]);
+    vasset_blob_free(&batch[2]);
+
+    // "res://a.bin" splits on '/' into directory "res:" holding file "a.bin".
+    EXPECT_EQ(vasset_vpk_is_directory(vpk, "res:"), 1);
+    EXPECT_EQ(vasset_vpk_is_directory(vpk, "res://a.bin"), 0);
+    VAssetVpkListingHandle listing = vasset_vpk_list_directory(vpk, "res:/");
+    ASSERT_NE(listing, nullptr);
+    ASSERT_EQ(vasset_vpk_listing_count(listing), 1u);
+    EXPECT_EQ(std::string(vasset_vpk_listing_name_at(listing, 0)), "a.bin");
+    EXPECT_EQ(vasset_vpk_listing_is_directory_at(listing, 0), 0);
+    vasset_vpk_listing_destroy(listing);
+    EXPECT_EQ(vasset_vpk_list_directory(vpk, "nope"), nullptr);
+
     // Resolver populated from the VPK registry resolves the embedded uuid.
     VAssetResolverHandle res = vasset_resolver_create();
     EXPECT_EQ(vasset_resolver_load_from_vpk(res, vpk), VASSET_OK);
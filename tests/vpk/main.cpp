@@ -0,0 +1,1450 @@
+// VPK package tests: writer/reader round-trips and the VpkFileSystem backends, driven through the C++
+// API with small synthetic payloads (no importer fixtures needed).
+#include <vasset/vpk.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vasset;
+
+namespace
+{
+    std::filesystem::path tempDir(const char* name)
+    {
+        auto dir = std::filesystem::temp_directory_path() / "vasset_vpk_test" / name;
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    std::vector<std::byte> makePayload(size_t size, uint32_t seed)
+    {
+        std::vector<std::byte> out(size);
+        for (size_t i = 0; i < size; ++i)
+            out[i] = static_cast<std::byte>((i * 31u + seed) % 251u);
+        return out;
+    }
+
+    VpkWriteItem makeItem(std::string logicalPath, std::vector<std::byte> bytes, bool allowCompress)
+    {
+        VpkWriteItem item;
+        item.uuid          = vbase::uuid_from_string_key(logicalPath);
+        item.type          = VAssetType::eUnknown;
+        item.logicalPath   = std::move(logicalPath);
+        item.bytes         = std::move(bytes);
+        item.allowCompress = allowCompress;
+        return item;
+    }
+
+    std::vector<std::byte> readAll(vfilesystem::IFileSystem& fs, vbase::StringView path)
+    {
+        auto file = fs.open(path, vfilesystem::FileMode::eRead);
+        if (!file)
+            return {};
+        return file.value()->readAllBytes();
+    }
+} // namespace
+
+TEST(VpkFileSystem, MemoryMappedMatchesStreamed)
+{
+    const auto vpkPath = (tempDir("mmap") / "pack.vpk").generic_string();
+
+    const auto raw    = makePayload(4096, 1);
+    const auto packed = makePayload(70000, 2);
+    ASSERT_TRUE(static_cast<bool>(
+        writeVpk(vpkPath, {makeItem("raw.bin", raw, false), makeItem("packed.bin", packed, true)}, 3)));
+
+    VpkFileSystem streamed(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(streamed.openPackage()));
+
+    VpkFileSystem mapped(vpkPath, VpkFileSystemOptions {.memoryMap = true});
+    ASSERT_TRUE(static_cast<bool>(mapped.openPackage()));
+
+    EXPECT_EQ(readAll(streamed, "raw.bin"), raw);
+    EXPECT_EQ(readAll(mapped, "raw.bin"), raw);
+    EXPECT_EQ(readAll(streamed, "packed.bin"), packed);
+    EXPECT_EQ(readAll(mapped, "packed.bin"), packed);
+
+    // Uncompressed entries are borrowed from the mapping; compressed ones cannot be viewed.
+    auto view = mapped.view("raw.bin");
+    ASSERT_TRUE(static_cast<bool>(view));
+    EXPECT_TRUE(std::equal(view.value().begin(), view.value().end(), raw.begin(), raw.end()));
+    EXPECT_EQ(mapped.view("packed.bin").error(), AssetError::eNotSupported);
+    EXPECT_EQ(streamed.view("raw.bin").error(), AssetError::eNotSupported);
+
+    // A borrowed file keeps the mapping alive after the filesystem is gone.
+    std::unique_ptr<vfilesystem::IFile> file;
+    {
+        VpkFileSystem scoped(vpkPath, VpkFileSystemOptions {.memoryMap = true});
+        ASSERT_TRUE(static_cast<bool>(scoped.openPackage()));
+        file = std::move(scoped.open("raw.bin", vfilesystem::FileMode::eRead)).value();
+    }
+    ASSERT_TRUE(file->seek(100));
+    std::byte b {};
+    ASSERT_EQ(file->read(&b, 1), 1u);
+    EXPECT_EQ(b, raw[100]);
+}
+
+TEST(VpkFileSystem, ExistsAndStatUseIndexOnly)
+{
+    const auto vpkPath = (tempDir("stat") / "pack.vpk").generic_string();
+
+    const auto packed = makePayload(50000, 3);
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, {makeItem("dir/packed.bin", packed, true)}, 3)));
+
+    VpkFileSystem fs(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+
+    // Delete the pack: index queries must still be answered, proving they never touch the payload.
+    std::filesystem::remove(vpkPath);
+
+    EXPECT_TRUE(fs.exists("dir/packed.bin"));
+    EXPECT_TRUE(fs.exists("/dir/packed.bin"));
+    EXPECT_TRUE(fs.isFile("dir/packed.bin"));
+    EXPECT_FALSE(fs.exists("dir/missing.bin"));
+
+    auto st = fs.stat("dir/packed.bin");
+    ASSERT_TRUE(static_cast<bool>(st));
+    EXPECT_EQ(st.value().rawSize, packed.size());
+    EXPECT_EQ(st.value().compression, VpkCompression::eZstd);
+    EXPECT_LT(st.value().packedSize, st.value().rawSize);
+    EXPECT_EQ(fs.stat("dir/missing.bin").error(), AssetError::eNotFound);
+}
+
+TEST(VpkFileSystem, CacheServesHotEntriesWithinBudget)
+{
+    const auto vpkPath = (tempDir("cache") / "pack.vpk").generic_string();
+
+    const auto a   = makePayload(40000, 1);
+    const auto b   = makePayload(40000, 2);
+    const auto big = makePayload(200000, 3);
+    ASSERT_TRUE(static_cast<bool>(writeVpk(
+        vpkPath, {makeItem("a.bin", a, true), makeItem("b.bin", b, false), makeItem("big.bin", big, true)}, 3)));
+
+    VpkFileSystemOptions options {};
+    options.cacheBudget = 64 * 1024; // room for one of a/b at a time
+    VpkFileSystem fs(vpkPath, options);
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+
+    EXPECT_EQ(readAll(fs, "a.bin"), a);
+    EXPECT_EQ(readAll(fs, "a.bin"), a);
+    auto st = fs.cacheStats();
+    EXPECT_EQ(st.misses, 1u);
+    EXPECT_EQ(st.hits, 1u);
+    EXPECT_EQ(st.entries, 1u);
+    EXPECT_EQ(st.bytes, a.size());
+
+    // A file opened from the cache keeps its buffer alive across eviction.
+    auto held = fs.open("a.bin", vfilesystem::FileMode::eRead);
+    ASSERT_TRUE(static_cast<bool>(held));
+    EXPECT_EQ(readAll(fs, "b.bin"), b);
+    st = fs.cacheStats();
+    EXPECT_EQ(st.evictions, 1u);
+    EXPECT_EQ(st.entries, 1u);
+    EXPECT_EQ(held.value()->readAllBytes(), a);
+
+    // Entries larger than the budget bypass the cache entirely.
+    EXPECT_EQ(readAll(fs, "big.bin"), big);
+    EXPECT_EQ(fs.cacheStats().misses, st.misses);
+
+    fs.clearCache();
+    EXPECT_EQ(fs.cacheStats().entries, 0u);
+    EXPECT_EQ(fs.cacheStats().bytes, 0u);
+}
+
+TEST(VpkFileSystem, AccessTraceRecordsFirstOpenOrder)
+{
+    const auto dir     = tempDir("trace");
+    const auto vpkPath = (dir / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    for (const char* path : {"a.bin", "b.bin", "c.bin", "d.bin"})
+        items.push_back(makeItem(path, makePayload(500, 1), true));
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, 3)));
+
+    VpkFileSystem fs(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+
+    auto session = [&](const std::filesystem::path& tracePath, std::vector<const char*> opens) {
+        ASSERT_TRUE(static_cast<bool>(fs.beginTrace(tracePath.generic_string())));
+        for (const char* path : opens)
+            fs.open(path, vfilesystem::FileMode::eRead);
+        fs.endTrace();
+    };
+    session(dir / "one.trace", {"/c.bin", "a.bin", "missing.bin", "c.bin"});
+    session(dir / "two.trace", {"d.bin", "b.bin", "a.bin"});
+
+    auto readLines = [](const std::filesystem::path& tracePath) {
+        std::ifstream            in(tracePath);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);)
+            lines.push_back(line);
+        return lines;
+    };
+    const auto lines = readLines(dir / "one.trace");
+    ASSERT_EQ(lines.size(), 4u); // header + three successful opens
+    EXPECT_TRUE(lines[1].ends_with("\t500\tc.bin"));
+
+    // An entry that exists but cannot be read is not recorded either.
+    const auto brokenPath = (dir / "broken.vpk").generic_string();
+    std::filesystem::copy_file(vpkPath, brokenPath, std::filesystem::copy_options::overwrite_existing);
+    VpkFileSystem broken(brokenPath);
+    ASSERT_TRUE(static_cast<bool>(broken.openPackage()));
+    std::filesystem::resize_file(brokenPath, findVpkEntry(broken.getVpk(), "b.bin")->dataOffset);
+    ASSERT_TRUE(static_cast<bool>(broken.beginTrace((dir / "broken.trace").generic_string())));
+    EXPECT_FALSE(static_cast<bool>(broken.open("b.bin", vfilesystem::FileMode::eRead)));
+    broken.endTrace();
+    EXPECT_EQ(readLines(dir / "broken.trace").size(), 1u); // header only
+
+    // c and d were each opened first in a session, then a and b second; ties keep trace order.
+    auto order = readVpkAccessTraces({(dir / "one.trace").generic_string(), (dir / "two.trace").generic_string()});
+    ASSERT_TRUE(static_cast<bool>(order));
+    EXPECT_EQ(order.value(), (std::vector<std::string> {"c.bin", "d.bin", "a.bin", "b.bin"}));
+
+    EXPECT_EQ(readVpkAccessTraces({vpkPath}).error(), AssetError::eInvalidFormat);
+    EXPECT_EQ(readVpkAccessTraces({(dir / "none.trace").generic_string()}).error(), AssetError::eNotFound);
+}
+
+TEST(VpkFileSystem, LargeEntriesStreamWithSeek)
+{
+    const auto vpkPath = (tempDir("streaming") / "pack.vpk").generic_string();
+
+    // Mix in an LCG so the compressed payload spans several zstd input chunks.
+    auto     packed = makePayload(3u << 20, 4);
+    uint32_t state  = 12345u;
+    for (size_t i = 0; i < packed.size(); i += 3)
+    {
+        state     = state * 1664525u + 1013904223u;
+        packed[i] = static_cast<std::byte>(state >> 24);
+    }
+    const auto raw = makePayload(300000, 5);
+    ASSERT_TRUE(static_cast<bool>(
+        writeVpk(vpkPath, {makeItem("big.bin", packed, true), makeItem("raw.bin", raw, false)}, 1)));
+
+    for (bool memoryMap : {false, true})
+    {
+        VpkFileSystem fs(vpkPath, VpkFileSystemOptions {.memoryMap = memoryMap, .streamingThreshold = 64 * 1024});
+        ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+
+        auto opened = fs.open("big.bin", vfilesystem::FileMode::eRead);
+        ASSERT_TRUE(static_cast<bool>(opened));
+        auto& file = *opened.value();
+        EXPECT_EQ(file.size(), packed.size());
+
+        // Odd-sized chunked reads reproduce the payload.
+        std::vector<std::byte> out;
+        std::vector<std::byte> chunk(7777);
+        while (size_t n = file.read(chunk.data(), chunk.size()))
+            out.insert(out.end(), chunk.begin(), chunk.begin() + static_cast<std::ptrdiff_t>(n));
+        EXPECT_EQ(out, packed);
+
+        // Backward and forward seeks land on the right bytes.
+        for (uint64_t pos : {uint64_t {1000}, uint64_t {2500000}, uint64_t {17}, uint64_t {packed.size() - 1}})
+        {
+            ASSERT_TRUE(file.seek(pos));
+            std::byte b {};
+            ASSERT_EQ(file.read(&b, 1), 1u);
+            EXPECT_EQ(b, packed[pos]);
+        }
+        EXPECT_FALSE(file.seek(packed.size() + 1));
+
+        ASSERT_TRUE(file.seek(packed.size() / 2));
+        auto tail = file.readAllBytes();
+        EXPECT_TRUE(std::equal(tail.begin(), tail.end(), packed.begin() + packed.size() / 2, packed.end()));
+
+        EXPECT_EQ(readAll(fs, "raw.bin"), raw);
+    }
+}
+
+TEST(VpkFileSystem, FramedEntriesDecodeOnlyTouchedFrames)
+{
+    const auto vpkPath = (tempDir("framed") / "pack.vpk").generic_string();
+
+    const auto big   = makePayload(200000, 6);
+    const auto small = makePayload(1000, 7);
+
+    VpkWriteOptions options {};
+    options.framedThreshold = 64 * 1024;
+    options.frameSize       = 16 * 1024;
+    ASSERT_TRUE(static_cast<bool>(
+        writeVpk(vpkPath, {makeItem("big.bin", big, true), makeItem("small.bin", small, true)}, options)));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    EXPECT_EQ(statVpkFile(opened.value(), "big.bin").value().compression, VpkCompression::eZstdFrames);
+    EXPECT_EQ(statVpkFile(opened.value(), "small.bin").value().compression, VpkCompression::eZstd);
+    EXPECT_EQ(readVpkFile(opened.value(), "", "big.bin").value(), big);
+
+    for (bool memoryMap : {false, true})
+    {
+        VpkFileSystem fs(vpkPath, VpkFileSystemOptions {.memoryMap = memoryMap});
+        ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+
+        auto file = std::move(fs.open("big.bin", vfilesystem::FileMode::eRead)).value();
+        EXPECT_EQ(file->size(), big.size());
+
+        // A read straddling a frame boundary, then random seeks in both directions.
+        std::vector<std::byte> window(5000);
+        ASSERT_TRUE(file->seek(16 * 1024 - 2500));
+        ASSERT_EQ(file->read(window.data(), window.size()), window.size());
+        EXPECT_TRUE(std::equal(window.begin(), window.end(), big.begin() + (16 * 1024 - 2500)));
+
+        for (uint64_t pos : {uint64_t {199999}, uint64_t {0}, uint64_t {123456}, uint64_t {65536}})
+        {
+            ASSERT_TRUE(file->seek(pos));
+            std::byte b {};
+            ASSERT_EQ(file->read(&b, 1), 1u);
+            EXPECT_EQ(b, big[pos]);
+        }
+
+        ASSERT_TRUE(file->seek(0));
+        EXPECT_EQ(file->readAllBytes(), big);
+        EXPECT_EQ(readAll(fs, "small.bin"), small);
+    }
+}
+
+TEST(VpkReadOnly, SmallEntriesUsePerTypeDictionaries)
+{
+    const auto dir = tempDir("dictionaries");
+
+    // Many tiny scene-like documents sharing most of their structure, plus a lone script.
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        const std::string text = "{\"type\":\"scene\",\"version\":3,\"entities\":[{\"name\":\"node" +
+                                 std::to_string(i) + "\",\"transform\":{\"position\":[" + std::to_string(i % 7) +
+                                 ",0,1],\"rotation\":[0,0,0,1],\"scale\":[1,1,1]},\"components\":[\"MeshRenderer\","
+                                 "\"Collider\"]}]}";
+        std::vector<std::byte> bytes(text.size());
+        std::memcpy(bytes.data(), text.data(), text.size());
+
+        auto item = makeItem("scenes/s" + std::to_string(i) + ".vscn", std::move(bytes), true);
+        item.type = VAssetType::eScene;
+        items.push_back(std::move(item));
+    }
+    auto script = makeItem("scripts/main.lua", makePayload(600, 8), true);
+    script.type = VAssetType::eScriptLua;
+    items.push_back(std::move(script));
+
+    const auto withDicts = (dir / "dict.vpk").generic_string();
+    const auto without   = (dir / "plain.vpk").generic_string();
+
+    VpkWriteOptions options {};
+    ASSERT_TRUE(static_cast<bool>(writeVpk(withDicts, items, options)));
+    options.trainDictionaries = false;
+    ASSERT_TRUE(static_cast<bool>(writeVpk(without, items, options)));
+
+    EXPECT_LT(std::filesystem::file_size(withDicts), std::filesystem::file_size(without));
+
+    auto opened = openVpk(withDicts);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    const VpkReadOnly& vpk = opened.value();
+    ASSERT_NE(vpk.dictionaries, nullptr);
+    auto dictSection = std::find_if(vpk.sections.begin(), vpk.sections.end(), [](const VpkSection& section) {
+        return section.kind == VpkSectionKind::eDictionaries;
+    });
+    ASSERT_NE(dictSection, vpk.sections.end());
+    EXPECT_EQ(dictSection->count, 1u); // the lone script is not worth a dictionary
+    EXPECT_NE(findVpkEntry(vpk, "scenes/s0.vscn")->dictionary, 0u);
+    EXPECT_EQ(findVpkEntry(vpk, "scripts/main.lua")->dictionary, 0u);
+
+    for (const auto& item : items)
+        EXPECT_EQ(readVpkFile(vpk, "", item.logicalPath).value(), item.bytes);
+
+    // Memory and streaming paths resolve the same dictionaries.
+    VpkFileSystem fs(withDicts, VpkFileSystemOptions {.memoryMap = true, .streamingThreshold = 1});
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+    EXPECT_EQ(readAll(fs, "scenes/s42.vscn"), items[42].bytes);
+}
+
+TEST(VpkReadOnly, OpensBaselineV3Packs)
+{
+    const auto dir = tempDir("legacy-v3");
+
+    // The v3 index record: everything after `compression` was unspecified padding.
+    struct LegacyEntry
+    {
+        uint64_t pathHash64;
+        uint32_t pathOffset;
+        uint32_t pathSize;
+        uint64_t dataOffset;
+        uint64_t packedSize;
+        uint64_t rawSize;
+        uint8_t  compression;
+        uint8_t  padding[7];
+    };
+    static_assert(sizeof(LegacyEntry) == sizeof(VpkEntry));
+
+    const std::vector<VpkWriteItem> items = {makeItem("a.txt", makePayload(100, 1), false),
+                                             makeItem("dir/b.bin", makePayload(300, 2), false)};
+
+    // Path hashes come from a current pack of the same items.
+    const auto currentPath = (dir / "current.vpk").generic_string();
+    ASSERT_TRUE(static_cast<bool>(writeVpk(currentPath, items, 3)));
+    auto current = openVpk(currentPath);
+    ASSERT_TRUE(static_cast<bool>(current));
+
+    // [Header (v3: no section fields)][Data][StringTable][Index][Registry], as the v3 writer laid it out.
+    std::vector<std::byte> image(offsetof(VpkHeader, sectionOffset));
+    auto                   append = [&image](const void* p, size_t n) {
+        image.insert(image.end(), static_cast<const std::byte*>(p), static_cast<const std::byte*>(p) + n);
+    };
+
+    VpkHeader header {};
+    std::memcpy(header.magic, "VPK\0", 4);
+    header.version    = 3;
+    header.fileCount  = static_cast<uint32_t>(items.size());
+    header.dataOffset = image.size();
+
+    std::vector<LegacyEntry>           entries;
+    std::vector<VpkAssetRegistryEntry> registry;
+    std::string                        strings;
+    for (const auto& item : items)
+    {
+        LegacyEntry e;
+        std::memset(&e, 0xCD, sizeof(e)); // garbage padding must not read back as flags or a dictionary
+        e.pathHash64  = findVpkEntry(current.value(), item.logicalPath)->pathHash64;
+        e.pathOffset  = static_cast<uint32_t>(strings.size());
+        e.pathSize    = static_cast<uint32_t>(item.logicalPath.size());
+        e.dataOffset  = image.size();
+        e.packedSize  = item.bytes.size();
+        e.rawSize     = item.bytes.size();
+        e.compression = static_cast<uint8_t>(VpkCompression::eNone);
+        entries.push_back(e);
+        append(item.bytes.data(), item.bytes.size());
+
+        VpkAssetRegistryEntry r {};
+        r.uuid       = item.uuid;
+        r.pathOffset = e.pathOffset;
+        r.pathSize   = e.pathSize;
+        registry.push_back(r);
+
+        strings += item.logicalPath;
+        strings.push_back('\0');
+    }
+
+    header.stringOffset = image.size();
+    header.stringSize   = strings.size();
+    append(strings.data(), strings.size());
+    header.indexOffset = image.size();
+    header.indexSize   = entries.size() * sizeof(LegacyEntry);
+    append(entries.data(), header.indexSize);
+    header.registryOffset = image.size();
+    header.registrySize   = registry.size() * sizeof(VpkAssetRegistryEntry);
+    header.registryCount  = static_cast<uint32_t>(registry.size());
+    append(registry.data(), header.registrySize);
+    std::memcpy(image.data(), &header, offsetof(VpkHeader, sectionOffset));
+
+    const auto legacyPath = (dir / "legacy.vpk").generic_string();
+    {
+        std::ofstream out(legacyPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    }
+
+    auto fromDisk   = openVpk(legacyPath);
+    auto fromMemory = openVpkFromMemory(image);
+    ASSERT_TRUE(static_cast<bool>(fromDisk));
+    ASSERT_TRUE(static_cast<bool>(fromMemory));
+    EXPECT_EQ(fromDisk.value().header.version, 3u);
+    for (const auto& item : items)
+    {
+        const VpkEntry* e = findVpkEntry(fromDisk.value(), item.logicalPath);
+        ASSERT_NE(e, nullptr) << item.logicalPath;
+        EXPECT_EQ(e->flags, 0u);
+        EXPECT_EQ(e->dictionary, 0u);
+        EXPECT_EQ(readVpkFile(fromDisk.value(), legacyPath, item.logicalPath).value(), item.bytes);
+        EXPECT_EQ(readVpkFileFromMemory(fromMemory.value(), image, item.logicalPath).value(), item.bytes);
+    }
+}
+
+TEST(VpkReadOnly, ParallelWriteIsDeterministic)
+{
+    const auto dir = tempDir("parallel_write");
+
+    // Dictionary-trained small entries, plain, stored and framed entries all go through the pool.
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        auto item = makeItem("small/" + std::to_string(i), makePayload(2000 + i * 13, i % 4), true);
+        item.type = VAssetType::eMaterial;
+        items.push_back(std::move(item));
+    }
+    items.push_back(makeItem("plain.bin", makePayload(100000, 7), true));
+    items.push_back(makeItem("stored.bin", makePayload(30000, 8), false));
+    items.push_back(makeItem("framed.bin", makePayload(600000, 9), true));
+
+    VpkWriteOptions options {};
+    options.framedThreshold = 512 * 1024;
+    options.frameSize       = 64 * 1024;
+
+    auto readFile = [](const std::filesystem::path& path) {
+        std::ifstream          in(path, std::ios::binary);
+        std::vector<std::byte> bytes(std::filesystem::file_size(path));
+        in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return bytes;
+    };
+
+    options.threads = 1;
+    ASSERT_TRUE(static_cast<bool>(writeVpk((dir / "serial.vpk").generic_string(), items, options)));
+    options.threads = 4;
+    ASSERT_TRUE(static_cast<bool>(writeVpk((dir / "parallel.vpk").generic_string(), items, options)));
+    EXPECT_EQ(readFile(dir / "serial.vpk"), readFile(dir / "parallel.vpk"));
+
+    auto opened = openVpk((dir / "parallel.vpk").generic_string());
+    ASSERT_TRUE(static_cast<bool>(opened));
+    for (const auto& item : items)
+    {
+        auto r = readVpkFile(opened.value(), (dir / "parallel.vpk").generic_string(), item.logicalPath);
+        ASSERT_TRUE(static_cast<bool>(r)) << item.logicalPath;
+        EXPECT_EQ(r.value(), item.bytes) << item.logicalPath;
+    }
+}
+
+TEST(VpkReadOnly, IncrementalWriterMatchesWriteVpk)
+{
+    const auto dir = tempDir("incremental_write");
+
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 40; ++i)
+    {
+        auto item = makeItem("mat/" + std::to_string(i), makePayload(1500 + i * 31, i % 3), true);
+        item.type = VAssetType::eMaterial;
+        items.push_back(std::move(item));
+        if (i % 10 == 0)
+            items.push_back(makeItem("blob/" + std::to_string(i), makePayload(80000, i), (i % 20) == 0));
+    }
+
+    VpkWriteOptions options {};
+    options.threads = 3;
+    ASSERT_TRUE(static_cast<bool>(writeVpk((dir / "batch.vpk").generic_string(), items, options)));
+
+    VpkWriter writer;
+    EXPECT_FALSE(static_cast<bool>(writer.add(items.front())));
+    ASSERT_TRUE(static_cast<bool>(writer.open((dir / "stream.vpk").generic_string(), options)));
+    for (const auto& item : items)
+        ASSERT_TRUE(static_cast<bool>(writer.add(item)));
+    EXPECT_EQ(writer.entryCount(), items.size());
+    ASSERT_TRUE(static_cast<bool>(writer.finish()));
+
+    auto readFile = [](const std::filesystem::path& path) {
+        std::ifstream          in(path, std::ios::binary);
+        std::vector<std::byte> bytes(std::filesystem::file_size(path));
+        in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return bytes;
+    };
+    EXPECT_EQ(readFile(dir / "batch.vpk"), readFile(dir / "stream.vpk"));
+
+    const auto streamPath = (dir / "stream.vpk").generic_string();
+    auto       opened     = openVpk(streamPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    for (const auto& item : items)
+    {
+        auto r = readVpkFile(opened.value(), streamPath, item.logicalPath);
+        ASSERT_TRUE(static_cast<bool>(r)) << item.logicalPath;
+        EXPECT_EQ(r.value(), item.bytes) << item.logicalPath;
+    }
+}
+
+TEST(VpkReadOnly, DuplicatePayloadsAreStoredOnce)
+{
+    const auto dir = tempDir("dedup");
+
+    const auto                shared = makePayload(20000, 7);
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 30; ++i)
+    {
+        items.push_back(makeItem("unique/" + std::to_string(i), makePayload(3000 + i, i), true));
+        if (i % 10 == 0)
+        {
+            items.push_back(makeItem("copies/packed" + std::to_string(i), shared, true));
+            items.push_back(makeItem("copies/stored" + std::to_string(i), shared, false));
+        }
+    }
+
+    VpkWriteOptions options {};
+    options.threads = 2;
+
+    VpkWriter writer;
+    ASSERT_TRUE(static_cast<bool>(writer.open((dir / "dedup.vpk").generic_string(), options)));
+    for (const auto& item : items)
+        ASSERT_TRUE(static_cast<bool>(writer.add(item)));
+    ASSERT_TRUE(static_cast<bool>(writer.finish()));
+    const VpkWriteStats stats = writer.stats();
+    EXPECT_EQ(stats.entries, items.size());
+    EXPECT_EQ(stats.dedupedEntries, 4u);
+    EXPECT_GT(stats.dedupedBytes, 0u);
+
+    options.deduplicate = false;
+    ASSERT_TRUE(static_cast<bool>(writeVpk((dir / "plain.vpk").generic_string(), items, options)));
+    // Without deduplication each stored copy also writes its full raw bytes.
+    const auto saved = std::filesystem::file_size(dir / "plain.vpk") - std::filesystem::file_size(dir / "dedup.vpk");
+    EXPECT_GT(saved, 2 * shared.size());
+    EXPECT_GE(saved, stats.dedupedBytes);
+
+    const auto vpkPath = (dir / "dedup.vpk").generic_string();
+    auto       opened  = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    // Copies share a payload only with copies encoded the same way: stored ones stay stored.
+    const VpkEntry* packed = findVpkEntry(opened.value(), "copies/packed0");
+    const VpkEntry* stored = findVpkEntry(opened.value(), "copies/stored0");
+    ASSERT_NE(packed, nullptr);
+    ASSERT_NE(stored, nullptr);
+    EXPECT_NE(packed->compression, VpkCompression::eNone);
+    EXPECT_EQ(stored->compression, VpkCompression::eNone);
+    EXPECT_NE(stored->dataOffset, packed->dataOffset);
+    const std::pair<const char*, const VpkEntry*> copies[] = {{"copies/packed10", packed},
+                                                               {"copies/packed20", packed},
+                                                               {"copies/stored10", stored},
+                                                               {"copies/stored20", stored}};
+    for (const auto& [path, first] : copies)
+    {
+        const VpkEntry* e = findVpkEntry(opened.value(), path);
+        ASSERT_NE(e, nullptr) << path;
+        EXPECT_EQ(e->dataOffset, first->dataOffset) << path;
+        EXPECT_EQ(e->compression, first->compression) << path;
+    }
+    for (const auto& item : items)
+        EXPECT_EQ(readVpkFile(opened.value(), vpkPath, item.logicalPath).value(), item.bytes) << item.logicalPath;
+
+    // Aliased entries share one decoded buffer in the cache.
+    VpkFileSystem fs(vpkPath, VpkFileSystemOptions {.cacheBudget = 1u << 20});
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+    ASSERT_TRUE(static_cast<bool>(fs.open("copies/packed0", vfilesystem::FileMode::eRead)));
+    ASSERT_TRUE(static_cast<bool>(fs.open("copies/packed20", vfilesystem::FileMode::eRead)));
+    EXPECT_EQ(fs.cacheStats().hits, 1u);
+    EXPECT_EQ(fs.cacheStats().entries, 1u);
+
+    // A stored copy can still be borrowed from a mapping.
+    VpkFileSystem mapped(vpkPath, VpkFileSystemOptions {.memoryMap = true});
+    ASSERT_TRUE(static_cast<bool>(mapped.openPackage()));
+    auto view = mapped.view("copies/stored20");
+    ASSERT_TRUE(static_cast<bool>(view));
+    EXPECT_TRUE(std::equal(view.value().begin(), view.value().end(), shared.begin(), shared.end()));
+}
+
+TEST(VpkReadOnly, PayloadsHonorRequestedAlignment)
+{
+    const auto dir = tempDir("alignment");
+
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        auto item = makeItem("a/" + std::to_string(i), makePayload(100 + i * 37, i), (i % 2) == 0);
+        item.type = (i % 4) == 0 ? VAssetType::eTexture : VAssetType::eMaterial;
+        items.push_back(std::move(item));
+    }
+    items.push_back(makeItem("a/empty", {}, false));
+
+    // A texture with the same bytes as a material is not deduplicated into the material's slot.
+    for (VAssetType type : {VAssetType::eMaterial, VAssetType::eTexture})
+    {
+        auto item = makeItem(type == VAssetType::eTexture ? "a/shared-texture" : "a/shared-material",
+                             makePayload(5000, 99),
+                             true);
+        item.type = type;
+        items.push_back(std::move(item));
+    }
+
+    VpkWriteOptions options {};
+    options.payloadAlignment                    = 16;
+    options.typeAlignment[VAssetType::eTexture] = 4096;
+
+    const auto vpkPath = (dir / "aligned.vpk").generic_string();
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, options)));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    EXPECT_EQ(vpkPayloadAlignment(opened.value().header), 16u);
+    for (const auto& item : items)
+    {
+        const VpkEntry* e = findVpkEntry(opened.value(), item.logicalPath);
+        ASSERT_NE(e, nullptr);
+        if (e->packedSize > 0)
+        {
+            EXPECT_EQ(e->dataOffset % (item.type == VAssetType::eTexture ? 4096 : 16), 0u) << item.logicalPath;
+        }
+        EXPECT_EQ(readVpkFile(opened.value(), vpkPath, item.logicalPath).value(), item.bytes) << item.logicalPath;
+    }
+
+    options.payloadAlignment = 24;
+    EXPECT_EQ(writeVpk((dir / "bad.vpk").generic_string(), items, options).error(), AssetError::eNotSupported);
+}
+
+TEST(VpkReadOnly, ChecksumsCatchCorruptPayloads)
+{
+    const auto dir = tempDir("checksums");
+
+    const auto stored = makePayload(5000, 1);
+    const auto packed = makePayload(60000, 2);
+    const auto shared = makePayload(3000, 3);
+    const std::vector<VpkWriteItem> items {makeItem("a/stored.bin", stored, false),
+                                           makeItem("a/packed.bin", packed, true),
+                                           makeItem("b/one.bin", shared, false),
+                                           makeItem("b/two.bin", shared, false)};
+
+    const auto vpkPath = (dir / "pack.vpk").generic_string();
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, VpkWriteOptions {})));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    VpkReadOnly vpk = opened.value();
+    ASSERT_EQ(vpk.checksums.size(), vpk.entries.size());
+
+    auto clean = verifyVpk(vpk, vpkPath, 2);
+    EXPECT_EQ(clean.checked, items.size());
+    EXPECT_EQ(clean.unverified, 0u);
+    EXPECT_TRUE(clean.corrupt.empty());
+
+    // Flip one byte inside the stored payload; the index itself is untouched.
+    const VpkEntry* e = findVpkEntry(vpk, "a/stored.bin");
+    ASSERT_NE(e, nullptr);
+    {
+        std::fstream f(vpkPath, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(static_cast<std::streamoff>(e->dataOffset + 10));
+        const char flipped = static_cast<char>(std::to_integer<uint8_t>(stored[10]) ^ 0xFF);
+        f.write(&flipped, 1);
+    }
+
+    auto dirty = verifyVpk(vpk, vpkPath, 2);
+    EXPECT_EQ(dirty.checked, items.size() - 1);
+    EXPECT_EQ(dirty.corrupt, std::vector<std::string> {"a/stored.bin"});
+
+    EXPECT_TRUE(static_cast<bool>(readVpkFile(vpk, vpkPath, "a/stored.bin")));
+    vpk.verifyOnRead = true;
+    EXPECT_EQ(readVpkFile(vpk, vpkPath, "a/stored.bin").error(), AssetError::eInvalidFormat);
+    EXPECT_EQ(readVpkFile(vpk, vpkPath, "a/packed.bin").value(), packed);
+
+    VpkFileSystem fs(vpkPath, VpkFileSystemOptions {.verifyOnRead = true});
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+    EXPECT_FALSE(static_cast<bool>(fs.open("a/stored.bin", vfilesystem::FileMode::eRead)));
+    EXPECT_EQ(readAll(fs, "b/two.bin"), shared);
+
+    // Packs written without checksums still decode, but nothing is verified.
+    VpkWriteOptions options {};
+    options.checksums  = false;
+    const auto bareVpk = (dir / "bare.vpk").generic_string();
+    ASSERT_TRUE(static_cast<bool>(writeVpk(bareVpk, items, options)));
+    auto bare = openVpk(bareVpk);
+    ASSERT_TRUE(static_cast<bool>(bare));
+    EXPECT_TRUE(bare.value().checksums.empty());
+    auto unchecked = verifyVpk(bare.value(), bareVpk);
+    EXPECT_EQ(unchecked.checked, 0u);
+    EXPECT_EQ(unchecked.unverified, items.size());
+    EXPECT_TRUE(unchecked.corrupt.empty());
+}
+
+TEST(VpkReadOnly, CodecSelectionFollowsCostModel)
+{
+    const auto dir = tempDir("codecs");
+
+    std::vector<std::byte> noise(20000);
+    uint32_t               state = 12345;
+    for (auto& b : noise)
+    {
+        state = state * 1664525u + 1013904223u;
+        b     = static_cast<std::byte>(state >> 24);
+    }
+    const std::vector<VpkWriteItem> items {makeItem("a/pattern.bin", makePayload(50000, 1), true),
+                                           makeItem("a/noise.bin", noise, true)};
+
+    auto pack = [&](const char* name, const VpkWriteOptions& options) {
+        const auto path = (dir / name).generic_string();
+        EXPECT_TRUE(static_cast<bool>(writeVpk(path, items, options)));
+        auto opened = openVpk(path);
+        EXPECT_TRUE(static_cast<bool>(opened));
+        for (const auto& item : items)
+            EXPECT_EQ(readVpkFile(opened.value(), path, item.logicalPath).value(), item.bytes) << item.logicalPath;
+        return std::pair {opened.value(), path};
+    };
+    auto codecOf = [](const VpkReadOnly& vpk, const char* path) { return findVpkEntry(vpk, path)->compression; };
+
+    VpkWriteOptions lz4 {};
+    lz4.codec = VpkCodec::eLz4;
+    auto [lz4Vpk, lz4Path] = pack("lz4.vpk", lz4);
+    EXPECT_EQ(codecOf(lz4Vpk, "a/pattern.bin"), VpkCompression::eLz4);
+    EXPECT_LT(findVpkEntry(lz4Vpk, "a/pattern.bin")->packedSize, 50000u);
+
+    VpkFileSystem fs(lz4Path);
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+    EXPECT_EQ(readAll(fs, "a/pattern.bin"), items[0].bytes);
+
+    // Slow reads: ratio wins, and noise that does not shrink is stored.
+    VpkWriteOptions ratio {};
+    ratio.codec     = VpkCodec::eAdaptive;
+    ratio.costModel = {
+        .readBytesPerSecond = 1.0e3, .zstdDecodeBytesPerSecond = 1.0e9, .lz4DecodeBytesPerSecond = 1.0e9};
+    auto [ratioVpk, ratioPath] = pack("ratio.vpk", ratio);
+    EXPECT_EQ(codecOf(ratioVpk, "a/pattern.bin"), VpkCompression::eZstd);
+    EXPECT_EQ(codecOf(ratioVpk, "a/noise.bin"), VpkCompression::eNone);
+
+    // Slow zstd decode: LZ4 wins.
+    VpkWriteOptions speed {};
+    speed.codec     = VpkCodec::eAdaptive;
+    speed.costModel = {
+        .readBytesPerSecond = 1.0e6, .zstdDecodeBytesPerSecond = 1.0e6, .lz4DecodeBytesPerSecond = 1.0e12};
+    auto [speedVpk, speedPath] = pack("speed.vpk", speed);
+    EXPECT_EQ(codecOf(speedVpk, "a/pattern.bin"), VpkCompression::eLz4);
+    EXPECT_EQ(codecOf(speedVpk, "a/noise.bin"), VpkCompression::eNone);
+
+    VpkWriter writer;
+    ASSERT_TRUE(static_cast<bool>(writer.open((dir / "stats.vpk").generic_string(), speed)));
+    for (const auto& item : items)
+        ASSERT_TRUE(static_cast<bool>(writer.add(item)));
+    ASSERT_TRUE(static_cast<bool>(writer.finish()));
+    EXPECT_EQ(writer.stats().lz4Entries, 1u);
+    EXPECT_EQ(writer.stats().storedEntries, 1u);
+    EXPECT_EQ(writer.stats().zstdEntries, 0u);
+}
+
+TEST(VpkReadOnly, ImageOpenUsesSortedIndexInPlace)
+{
+    const auto vpkPath = (tempDir("sorted") / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 2000; ++i)
+    {
+        const auto path = "dir" + std::to_string(i % 13) + "/f" + std::to_string(i);
+        items.push_back(makeItem(path, makePayload(i % 40, i), false));
+    }
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, 3)));
+
+    std::ifstream in(vpkPath, std::ios::binary);
+    auto          image = std::make_shared<std::vector<std::byte>>(std::filesystem::file_size(vpkPath));
+    in.read(reinterpret_cast<char*>(image->data()), static_cast<std::streamsize>(image->size()));
+    const vbase::ConstByteSpan bytes {image->data(), image->size()};
+
+    auto opened = openVpkFromImage(image, bytes);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    const VpkReadOnly& vpk = opened.value();
+    EXPECT_NE(vpk.header.flags & kVpkFlagSortedIndex, 0u);
+    EXPECT_TRUE(std::is_sorted(vpk.entries.begin(), vpk.entries.end(), [](const VpkEntry& a, const VpkEntry& b) {
+        return a.pathHash64 < b.pathHash64;
+    }));
+
+    // The index and string table are the image's own bytes, not copies.
+    const auto* begin = reinterpret_cast<const std::byte*>(vpk.entries.data());
+    EXPECT_TRUE(begin >= bytes.data() && begin < bytes.data() + bytes.size());
+    EXPECT_TRUE(reinterpret_cast<const std::byte*>(vpk.stringTable.data()) >= bytes.data());
+
+    for (const auto& item : items)
+    {
+        const VpkEntry* e = findVpkEntry(vpk, item.logicalPath);
+        ASSERT_NE(e, nullptr) << item.logicalPath;
+        EXPECT_EQ(e->rawSize, item.bytes.size());
+    }
+    EXPECT_EQ(findVpkEntry(vpk, "dir0/missing"), nullptr);
+    EXPECT_EQ(readVpkFileFromMemory(vpk, bytes, "/dir3/f42").value(), items[42].bytes);
+
+    // openVpkFromMemory still copies, so the blob may go away.
+    auto copied = openVpkFromMemory(bytes);
+    ASSERT_TRUE(static_cast<bool>(copied));
+    const auto* copiedBegin = reinterpret_cast<const std::byte*>(copied.value().entries.data());
+    EXPECT_FALSE(copiedBegin >= bytes.data() && copiedBegin < bytes.data() + bytes.size());
+    EXPECT_NE(findVpkEntry(copied.value(), "dir10/f1999"), nullptr);
+}
+
+TEST(VpkFileSystem, DirectoryTableListsChildren)
+{
+    const auto vpkPath = (tempDir("directories") / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    for (const char* path : {"levels/b.vscn", "levels/a.vscn", "levels/caves/deep.vscn", "levels/caves/entry.vscn",
+                             "levels/zone/x/y.lua", "textures/t.ktx2", "root.txt"})
+        items.push_back(makeItem(path, makePayload(64, 9), true));
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, 3)));
+
+    for (bool memoryMap : {false, true})
+    {
+        VpkFileSystem fs(vpkPath, VpkFileSystemOptions {.memoryMap = memoryMap});
+        ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+        EXPECT_FALSE(fs.getVpk().directories.empty());
+
+        EXPECT_TRUE(fs.isDirectory(""));
+        EXPECT_TRUE(fs.isDirectory("/levels/"));
+        EXPECT_TRUE(fs.isDirectory("levels/zone/x"));
+        EXPECT_FALSE(fs.isDirectory("levels/a.vscn"));
+        EXPECT_FALSE(fs.isDirectory("level"));
+
+        auto names = [&](vbase::StringView dir) {
+            std::vector<std::string> out;
+            auto                     listed = fs.listDirectory(dir);
+            if (listed)
+                for (const auto& child : listed.value())
+                    out.push_back(std::string(child.name) + (child.isDirectory ? "/" : ""));
+            return out;
+        };
+
+        EXPECT_EQ(names("levels"), (std::vector<std::string> {"caves/", "zone/", "a.vscn", "b.vscn"}));
+        EXPECT_EQ(names("/"), (std::vector<std::string> {"levels/", "textures/", "root.txt"}));
+        EXPECT_EQ(names("levels/caves"), (std::vector<std::string> {"deep.vscn", "entry.vscn"}));
+        EXPECT_EQ(fs.listDirectory("levels/nope").error(), AssetError::eNotFound);
+
+        auto listed = fs.listDirectory("textures");
+        ASSERT_TRUE(static_cast<bool>(listed));
+        ASSERT_EQ(listed.value().size(), 1u);
+        EXPECT_EQ(listed.value()[0].entry, findVpkEntry(fs.getVpk(), "textures/t.ktx2"));
+    }
+}
+
+TEST(VpkFileSystem, FrontCodedPathsMatchPlainTable)
+{
+    const auto dir = tempDir("front-coded");
+
+    std::vector<VpkWriteItem> items;
+    for (int i = 0; i < 150; ++i)
+    {
+        const std::string biome = i % 3 == 0 ? "forest" : i % 3 == 1 ? "desert" : "tundra";
+        items.push_back(makeItem("models/environment/" + biome + "/props/rock_cluster_" + std::to_string(i) + ".vmesh",
+                                 makePayload(200 + i, i),
+                                 i % 2 == 0));
+    }
+    items.push_back(makeItem("root.txt", makePayload(10, 1), false));
+
+    VpkWriteOptions plainOptions {};
+    plainOptions.trainDictionaries = false;
+    VpkWriteOptions frontCodedOptions = plainOptions;
+    frontCodedOptions.frontCodedPaths = true;
+    const auto plainPath              = (dir / "plain.vpk").generic_string();
+    const auto frontCodedPath         = (dir / "front-coded.vpk").generic_string();
+    ASSERT_TRUE(static_cast<bool>(writeVpk(plainPath, items, plainOptions)));
+    ASSERT_TRUE(static_cast<bool>(writeVpk(frontCodedPath, items, frontCodedOptions)));
+
+    auto plain = openVpk(plainPath);
+    ASSERT_TRUE(static_cast<bool>(plain));
+    EXPECT_TRUE(plain.value().pathBuckets.empty());
+
+    for (bool memoryMap : {false, true})
+    {
+        VpkFileSystem fs(frontCodedPath, VpkFileSystemOptions {.memoryMap = memoryMap});
+        ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+        const VpkReadOnly& vpk = fs.getVpk();
+        ASSERT_TRUE(vpk.header.flags & kVpkFlagFrontCodedPaths);
+        EXPECT_EQ(vpk.pathBuckets.size(), (items.size() + kVpkPathBucketSize - 1) / kVpkPathBucketSize);
+        EXPECT_LT(vpk.stringTable.size() + vpk.pathData.size(), plain.value().stringTable.size() / 3);
+
+        std::string scratch;
+        for (const auto& item : items)
+        {
+            const VpkEntry* e = findVpkEntry(vpk, item.logicalPath);
+            ASSERT_NE(e, nullptr) << item.logicalPath;
+            EXPECT_EQ(vpkPathOf(vpk, *e, scratch), item.logicalPath);
+            EXPECT_EQ(findVpkEntryByUuid(vpk, item.uuid), e);
+            EXPECT_EQ(readAll(fs, item.logicalPath), item.bytes) << item.logicalPath;
+        }
+        for (const auto& r : vpk.registry)
+            EXPECT_NE(findVpkEntry(vpk, vpkPathOf(vpk, r, scratch)), nullptr);
+        EXPECT_EQ(findVpkEntry(vpk, "models/environment/forest/props/rock_cluster_1.vmesh"), nullptr);
+        EXPECT_EQ(findVpkEntry(vpk, "models/environment/forest"), nullptr);
+
+        // Listings hand out the same names as a plain table.
+        for (const char* path : {"", "models/environment", "models/environment/desert/props"})
+        {
+            auto expected = listVpkDirectory(plain.value(), path);
+            auto listed   = fs.listDirectory(path);
+            ASSERT_TRUE(static_cast<bool>(expected));
+            ASSERT_TRUE(static_cast<bool>(listed));
+            ASSERT_EQ(listed.value().size(), expected.value().size()) << path;
+            for (size_t i = 0; i < listed.value().size(); ++i)
+            {
+                EXPECT_EQ(listed.value()[i].name, expected.value()[i].name);
+                EXPECT_EQ(listed.value()[i].isDirectory, expected.value()[i].isDirectory);
+            }
+        }
+        EXPECT_TRUE(fs.isDirectory("models/environment/tundra/props"));
+        EXPECT_TRUE(verifyVpk(vpk, frontCodedPath).corrupt.empty());
+    }
+}
+
+TEST(VpkFileSystem, VolumesSplitPayloadsAcrossFiles)
+{
+    const auto vpkPath = (tempDir("volumes") / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 40; ++i)
+        items.push_back(makeItem("v/" + std::to_string(i), makePayload(1000 + i * 50, i), i % 2 == 0));
+    items.push_back(makeItem("v/large", makePayload(20000, 99), false));
+    items.push_back(makeItem("v/copy", items[3].bytes, items[3].allowCompress));
+
+    VpkWriteOptions options {};
+    options.trainDictionaries = false;
+    options.payloadAlignment  = 16;
+    options.volumeSize        = 8192;
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, options)));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    const VpkReadOnly& vpk = opened.value();
+    ASSERT_TRUE(vpk.header.flags & kVpkFlagVolumes);
+    ASSERT_GT(vpk.volumeSizes.size(), 2u);
+    EXPECT_LT(std::filesystem::file_size(vpkPath), 20000u); // the payloads are all in the volumes
+
+    // Volumes stay within the limit unless a single payload is larger.
+    for (uint32_t v = 0; v < vpk.volumeSizes.size(); ++v)
+    {
+        EXPECT_EQ(std::filesystem::file_size(vpkVolumePath(vpkPath, v)), vpk.volumeSizes[v]);
+        if (vpk.volumeSizes[v] > options.volumeSize)
+        {
+            EXPECT_EQ(std::count_if(vpk.entries.begin(), vpk.entries.end(), [v](const VpkEntry& e) {
+                          return e.volume == v;
+                      }),
+                      1);
+        }
+    }
+    EXPECT_EQ(findVpkEntry(vpk, "v/copy")->volume, findVpkEntry(vpk, "v/3")->volume);
+
+    std::vector<vbase::StringView> paths;
+    for (const auto& item : items)
+        paths.push_back(item.logicalPath);
+    VpkBatchReadOptions batchOptions {};
+    batchOptions.maxGap = 64 * 1024;
+    const auto reads    = readVpkFiles(vpk, vpkPath, paths, batchOptions);
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        EXPECT_EQ(reads[i].bytes, items[i].bytes) << items[i].logicalPath;
+        auto single = readVpkFile(vpk, vpkPath, items[i].logicalPath);
+        ASSERT_TRUE(static_cast<bool>(single));
+        EXPECT_EQ(single.value(), items[i].bytes);
+    }
+    EXPECT_TRUE(verifyVpk(vpk, vpkPath).corrupt.empty());
+
+    // A mapped package reads its payloads from the volumes too, streamed or whole.
+    for (bool memoryMap : {false, true})
+    {
+        VpkFileSystem fs(vpkPath, VpkFileSystemOptions {.memoryMap = memoryMap, .streamingThreshold = 4096});
+        ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+        for (const auto& item : items)
+            EXPECT_EQ(readAll(fs, item.logicalPath), item.bytes) << item.logicalPath;
+        EXPECT_EQ(fs.view("v/1").error(), AssetError::eNotSupported);
+    }
+
+    // An embedded image has no volumes to read from.
+    std::ifstream          in(vpkPath, std::ios::binary);
+    std::vector<std::byte> image(std::filesystem::file_size(vpkPath));
+    in.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    VpkFileSystem embedded(image);
+    EXPECT_EQ(embedded.openPackage().error(), AssetError::eNotSupported);
+    EXPECT_EQ(embedded.openPackage().error(), AssetError::eNotSupported); // the blob is kept, not dropped
+
+    // Nor has a pack opened from memory: its reads are refused rather than looked up next to nothing.
+    auto fromMemory = openVpkFromMemory(image);
+    ASSERT_TRUE(static_cast<bool>(fromMemory));
+    std::vector<std::byte> scratch;
+    EXPECT_EQ(readVpkFileFromMemory(fromMemory.value(), image, "v/1").error(), AssetError::eNotSupported);
+    EXPECT_EQ(readVpkFileFromMemoryInto(fromMemory.value(), image, "v/1", scratch).error(),
+              AssetError::eNotSupported);
+    const vbase::StringView memoryPaths[] = {"v/1", "v/large"};
+    for (const auto& read : readVpkFilesFromMemory(fromMemory.value(), image, memoryPaths))
+        EXPECT_EQ(read.error, AssetError::eNotSupported);
+
+    // Volumes are opened on first use: one removed after open only fails the entries it holds.
+    auto lazy = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(lazy));
+    const VpkEntry* last = findVpkEntry(lazy.value(), "v/large");
+    ASSERT_NE(last, nullptr);
+    std::filesystem::remove(vpkVolumePath(vpkPath, last->volume));
+    EXPECT_EQ(readVpkFile(lazy.value(), vpkPath, "v/large").error(), AssetError::eIOError);
+    for (const auto& item : items)
+    {
+        if (findVpkEntry(lazy.value(), item.logicalPath)->volume != last->volume)
+        {
+            EXPECT_TRUE(static_cast<bool>(readVpkFile(lazy.value(), vpkPath, item.logicalPath)));
+        }
+    }
+}
+
+TEST(VpkFileSystem, PatchOverlayHidesRemovedEntries)
+{
+    const auto dir = tempDir("patch");
+
+    std::vector<VpkWriteItem> baseItems;
+    baseItems.push_back(makeItem("levels/a.vscn", makePayload(4000, 1), true));
+    baseItems.push_back(makeItem("levels/b.vscn", makePayload(4000, 2), true));
+    baseItems.push_back(makeItem("levels/old.vscn", makePayload(900, 3), false));
+    baseItems.push_back(makeItem("textures/t.ktx2", makePayload(7000, 4), false));
+    ASSERT_TRUE(static_cast<bool>(writeVpk((dir / "base.vpk").generic_string(), baseItems, 3)));
+
+    std::vector<VpkWriteItem> newItems;
+    newItems.push_back(baseItems[0]);
+    newItems.push_back(makeItem("levels/b.vscn", makePayload(4100, 5), true));
+    newItems.push_back(baseItems[3]);
+    newItems.push_back(makeItem("levels/new/c.vscn", makePayload(1200, 6), true));
+    newItems[1].dependencies = {newItems[3].uuid, newItems[2].uuid};
+    ASSERT_TRUE(static_cast<bool>(writeVpk((dir / "new.vpk").generic_string(), newItems, 3)));
+
+    const auto patchPath = (dir / "patch.vpk").generic_string();
+    auto       stats     = writeVpkPatch(
+        patchPath, (dir / "base.vpk").generic_string(), (dir / "new.vpk").generic_string());
+    ASSERT_TRUE(static_cast<bool>(stats));
+    EXPECT_EQ(stats.value().added, 1u);
+    EXPECT_EQ(stats.value().changed, 1u);
+    EXPECT_EQ(stats.value().removed, 1u);
+    EXPECT_EQ(stats.value().unchanged, 2u);
+
+    auto patch = openVpk(patchPath);
+    ASSERT_TRUE(static_cast<bool>(patch));
+    EXPECT_NE(patch.value().header.flags & kVpkFlagPatch, 0u);
+    EXPECT_EQ(patch.value().entries.size(), 3u);
+    EXPECT_EQ(findVpkEntry(patch.value(), "levels/a.vscn"), nullptr);
+    EXPECT_EQ(findVpkEntry(patch.value(), "levels/old.vscn"), nullptr);
+    const VpkEntry* tombstone = findVpkEntryOrTombstone(patch.value(), "levels/old.vscn");
+    ASSERT_NE(tombstone, nullptr);
+    EXPECT_NE(tombstone->flags & kVpkEntryFlagTombstone, 0);
+
+    // The changed scene keeps its edge to the added one; the unchanged texture lives only in the base.
+    const auto closure = collectVpkDependencies(patch.value(), newItems[1].uuid);
+    ASSERT_EQ(closure.size(), 2u);
+    EXPECT_EQ(patch.value().registry[closure[1]].uuid, newItems[3].uuid);
+
+    VpkOverlayFileSystem overlay;
+    for (const char* name : {"base.vpk", "patch.vpk"})
+    {
+        auto layer = std::make_shared<VpkFileSystem>((dir / name).generic_string());
+        ASSERT_TRUE(static_cast<bool>(layer->openPackage()));
+        overlay.mount(std::move(layer));
+    }
+    EXPECT_EQ(overlay.layerCount(), 2u);
+
+    for (const auto& item : newItems)
+    {
+        auto file = overlay.open(item.logicalPath, vfilesystem::FileMode::eRead);
+        ASSERT_TRUE(static_cast<bool>(file)) << item.logicalPath;
+        EXPECT_EQ(file.value()->readAllBytes(), item.bytes) << item.logicalPath;
+        EXPECT_EQ(overlay.stat(item.logicalPath).value().rawSize, item.bytes.size());
+    }
+    EXPECT_FALSE(overlay.exists("levels/old.vscn"));
+    EXPECT_FALSE(static_cast<bool>(overlay.open("levels/old.vscn", vfilesystem::FileMode::eRead)));
+    EXPECT_TRUE(overlay.isDirectory("levels/new"));
+
+    auto listed = overlay.listDirectory("/levels/");
+    ASSERT_TRUE(static_cast<bool>(listed));
+    std::vector<std::string> names;
+    for (const auto& child : listed.value())
+        names.push_back(std::string(child.name) + (child.isDirectory ? "/" : ""));
+    EXPECT_EQ(names, (std::vector<std::string> {"new/", "a.vscn", "b.vscn"}));
+}
+
+TEST(VpkReadOnly, UuidIndexResolvesEntriesWithoutPaths)
+{
+    const auto vpkPath = (tempDir("uuid-index") / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    for (int i = 0; i < 64; ++i)
+        items.push_back(makeItem("textures/t" + std::to_string(i) + ".ktx2", makePayload(500 + i * 7, i), i % 2 == 0));
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, 3)));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    const VpkReadOnly& vpk = opened.value();
+    ASSERT_EQ(vpk.uuidIndex.size(), items.size());
+
+    // The UUID index and the registry scan used for packs without one agree.
+    VpkReadOnly legacy = vpk;
+    legacy.uuidIndex   = {};
+    for (const auto& item : items)
+    {
+        const VpkEntry* e = findVpkEntryByUuid(vpk, item.uuid);
+        ASSERT_NE(e, nullptr);
+        EXPECT_EQ(e, findVpkEntry(vpk, item.logicalPath));
+        EXPECT_EQ(findVpkEntryByUuid(legacy, item.uuid), e);
+        EXPECT_EQ(findVpkRegistryIndex(vpk, item.uuid), findVpkRegistryIndex(legacy, item.uuid));
+
+        auto read = readVpkFileByUuid(vpk, vpkPath, item.uuid);
+        ASSERT_TRUE(static_cast<bool>(read));
+        EXPECT_EQ(read.value(), item.bytes);
+    }
+
+    const auto unknown = vbase::uuid_from_string_key("textures/missing.ktx2");
+    EXPECT_EQ(findVpkEntryByUuid(vpk, unknown), nullptr);
+    EXPECT_EQ(findVpkRegistryIndex(vpk, unknown), UINT32_MAX);
+    auto missing = readVpkFileByUuid(vpk, vpkPath, unknown);
+    ASSERT_FALSE(static_cast<bool>(missing));
+    EXPECT_EQ(missing.error(), AssetError::eNotFound);
+
+    VpkFileSystem fs(vpkPath, VpkFileSystemOptions {.memoryMap = true});
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+    auto file = fs.open(items[5].uuid);
+    ASSERT_TRUE(static_cast<bool>(file));
+    EXPECT_EQ(file.value()->readAllBytes(), items[5].bytes);
+    EXPECT_FALSE(static_cast<bool>(fs.open(unknown)));
+}
+
+TEST(VpkFileSystem, PrefetchWalksDependencyGraph)
+{
+    const auto vpkPath = (tempDir("prefetch") / "pack.vpk").generic_string();
+
+    auto scene    = makeItem("scenes/level.vscn", makePayload(3000, 1), true);
+    auto material = makeItem("materials/wall.vmat", makePayload(2000, 2), true);
+    auto texture  = makeItem("textures/wall.ktx2", makePayload(5000, 3), false);
+    auto mesh     = makeItem("meshes/wall.vmesh", makePayload(4000, 4), true);
+    auto orphan   = makeItem("misc/orphan.bin", makePayload(1000, 5), true);
+    scene.dependencies    = {material.uuid, mesh.uuid, vbase::uuid_from_string_key("not/packed")};
+    material.dependencies = {texture.uuid, texture.uuid, material.uuid};
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, {scene, material, texture, mesh, orphan}, 3)));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    const VpkReadOnly& vpk = opened.value();
+    ASSERT_EQ(vpk.dependencies.size(), vpk.registry.size());
+    EXPECT_EQ(vpk.dependencyTargets.size(), 3u); // the unpacked UUID, the repeat and the self edge are gone
+
+    auto pathsOf = [&](const std::vector<uint32_t>& indices) {
+        std::vector<std::string> paths;
+        std::string              scratch;
+        for (const uint32_t i : indices)
+            paths.emplace_back(vpkPathOf(vpk, vpk.registry[i], scratch));
+        return paths;
+    };
+    EXPECT_EQ(pathsOf(collectVpkDependencies(vpk, scene.uuid, 0)), std::vector<std::string> {scene.logicalPath});
+    EXPECT_EQ(pathsOf(collectVpkDependencies(vpk, scene.uuid, 1)),
+              (std::vector<std::string> {scene.logicalPath, material.logicalPath, mesh.logicalPath}));
+    EXPECT_EQ(pathsOf(collectVpkDependencies(vpk, scene.uuid)),
+              (std::vector<std::string> {
+                  scene.logicalPath, material.logicalPath, mesh.logicalPath, texture.logicalPath}));
+    EXPECT_TRUE(collectVpkDependencies(vpk, vbase::uuid_from_string_key("not/packed")).empty());
+
+    VpkFileSystemOptions options {};
+    options.cacheBudget = 1 << 20;
+    VpkFileSystem fs(vpkPath, options);
+    ASSERT_TRUE(static_cast<bool>(fs.openPackage()));
+
+    auto prefetched = fs.prefetch(scene.uuid);
+    EXPECT_EQ(prefetched.entries, 4u);
+    ASSERT_TRUE(prefetched.decoded.valid());
+    prefetched.decoded.wait();
+    EXPECT_EQ(fs.cacheStats().entries, 4u);
+
+    EXPECT_EQ(readAll(fs, texture.logicalPath), texture.bytes);
+    EXPECT_EQ(readAll(fs, orphan.logicalPath), orphan.bytes);
+    EXPECT_EQ(fs.cacheStats().hits, 1u);
+    EXPECT_EQ(fs.cacheStats().misses, 1u);
+
+    // Without a cache only the readahead hints are issued.
+    VpkFileSystem mapped(vpkPath, VpkFileSystemOptions {.memoryMap = true});
+    ASSERT_TRUE(static_cast<bool>(mapped.openPackage()));
+    auto hinted = mapped.prefetch(material.uuid);
+    EXPECT_EQ(hinted.entries, 2u);
+    EXPECT_FALSE(hinted.decoded.valid());
+
+    // Destroying a filesystem joins its prefetch thread; requests still queued are resolved, not lost.
+    std::vector<std::shared_future<void>> pending;
+    {
+        VpkFileSystem scoped(vpkPath, options);
+        ASSERT_TRUE(static_cast<bool>(scoped.openPackage()));
+        for (int i = 0; i < 8; ++i)
+            pending.push_back(scoped.prefetch(scene.uuid).decoded);
+    }
+    for (const auto& done : pending)
+        EXPECT_EQ(done.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+}
+
+TEST(VpkFileSystem, MultiMountHonorsPriorities)
+{
+    const auto dir = tempDir("multi");
+
+    const auto baseShared = makePayload(3000, 1);
+    const auto dlcShared  = makePayload(3100, 2);
+    ASSERT_TRUE(static_cast<bool>(writeVpk((dir / "base.vpk").generic_string(),
+                                           {makeItem("data/shared.bin", baseShared, true),
+                                            makeItem("data/base.bin", makePayload(500, 3), false),
+                                            makeItem("data/cut.bin", makePayload(600, 4), false)},
+                                           3)));
+    {
+        VpkWriter writer;
+        ASSERT_TRUE(static_cast<bool>(writer.open((dir / "dlc.vpk").generic_string(), VpkWriteOptions {})));
+        ASSERT_TRUE(static_cast<bool>(writer.add(makeItem("data/shared.bin", dlcShared, true))));
+        ASSERT_TRUE(static_cast<bool>(writer.add(makeItem("dlc/extra.bin", makePayload(700, 5), false))));
+        ASSERT_TRUE(static_cast<bool>(writer.addTombstone("data/cut.bin")));
+        ASSERT_TRUE(static_cast<bool>(writer.finish()));
+    }
+
+    auto openPack = [&](const char* name) {
+        auto pack = std::make_shared<VpkFileSystem>((dir / name).generic_string());
+        EXPECT_TRUE(static_cast<bool>(pack->openPackage()));
+        return pack;
+    };
+
+    // Equal priorities: the later mount wins, and its tombstone hides the base copy.
+    VpkMultiFileSystem multi;
+    multi.mount(openPack("base.vpk"));
+    multi.mount(openPack("dlc.vpk"));
+    EXPECT_EQ(multi.mountCount(), 2u);
+    EXPECT_EQ(multi.fileCount(), 3u);
+    EXPECT_EQ(readAll(multi, "data/shared.bin"), dlcShared);
+    EXPECT_EQ(readAll(multi, "/dlc/extra.bin"), makePayload(700, 5));
+    EXPECT_TRUE(multi.exists("data/base.bin"));
+    EXPECT_FALSE(multi.exists("data/cut.bin"));
+    EXPECT_FALSE(multi.exists("data/missing.bin"));
+    EXPECT_EQ(multi.stat("data/missing.bin").error(), AssetError::eNotFound);
+    EXPECT_TRUE(multi.isDirectory("dlc"));
+
+    auto listed = multi.listDirectory("data");
+    ASSERT_TRUE(static_cast<bool>(listed));
+    std::vector<std::string> names;
+    for (const auto& child : listed.value())
+        names.push_back(std::string(child.name));
+    EXPECT_EQ(names, (std::vector<std::string> {"base.bin", "shared.bin"}));
+
+    // A higher priority outranks mount order, and a tombstone below it has no effect.
+    VpkMultiFileSystem pinned;
+    pinned.mount(openPack("base.vpk"), 10);
+    pinned.mount(openPack("dlc.vpk"));
+    EXPECT_EQ(pinned.fileCount(), 4u);
+    EXPECT_EQ(readAll(pinned, "data/shared.bin"), baseShared);
+    EXPECT_TRUE(pinned.exists("data/cut.bin"));
+    EXPECT_EQ(pinned.stat("data/shared.bin").value().rawSize, baseShared.size());
+
+    // view() borrows from the image of the mount serving the path.
+    VpkMultiFileSystem mapped;
+    for (const char* name : {"base.vpk", "dlc.vpk"})
+    {
+        auto pack = std::make_shared<VpkFileSystem>((dir / name).generic_string(),
+                                                    VpkFileSystemOptions {.memoryMap = true});
+        ASSERT_TRUE(static_cast<bool>(pack->openPackage()));
+        mapped.mount(std::move(pack));
+    }
+    const auto extra = makePayload(700, 5);
+    auto       view  = mapped.view("dlc/extra.bin");
+    ASSERT_TRUE(static_cast<bool>(view));
+    EXPECT_TRUE(std::equal(view.value().begin(), view.value().end(), extra.begin(), extra.end()));
+    EXPECT_EQ(mapped.stat("dlc/extra.bin").value().compression, VpkCompression::eNone);
+    EXPECT_EQ(mapped.view("data/cut.bin").error(), AssetError::eNotFound);
+}
+
+TEST(VpkReadOnly, BatchReadsMatchSingleReads)
+{
+    const auto vpkPath = (tempDir("batch") / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 300; ++i)
+        items.push_back(makeItem("b/" + std::to_string(i), makePayload(100 + (i * 37) % 5000, i), (i % 3) != 0));
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, 3)));
+
+    // Request a shuffled subset with a duplicate and a miss; a tiny gap/span forces several runs.
+    std::vector<std::string> paths;
+    for (uint32_t i = 0; i < 300; i += 7)
+        paths.push_back("b/" + std::to_string((i * 131) % 300));
+    paths.push_back("b/5");
+    paths.push_back("b/5");
+    paths.push_back("b/missing");
+    std::vector<vbase::StringView> views(paths.begin(), paths.end());
+
+    VpkBatchReadOptions options {};
+    options.threads = 4;
+    options.maxSpan = 16 * 1024;
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    const auto reads = readVpkFiles(opened.value(), vpkPath, views, options);
+    ASSERT_EQ(reads.size(), paths.size());
+
+    std::ifstream          in(vpkPath, std::ios::binary);
+    std::vector<std::byte> image(std::filesystem::file_size(vpkPath));
+    in.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    const auto memoryReads = readVpkFilesFromMemory(opened.value(), image, views, options);
+
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        auto single = readVpkFile(opened.value(), vpkPath, paths[i]);
+        if (!single)
+        {
+            EXPECT_EQ(reads[i].error, AssetError::eNotFound);
+            EXPECT_EQ(memoryReads[i].error, AssetError::eNotFound);
+            continue;
+        }
+        EXPECT_EQ(reads[i].error, AssetError::eOk);
+        EXPECT_EQ(reads[i].bytes, single.value()) << paths[i];
+        EXPECT_EQ(memoryReads[i].bytes, single.value()) << paths[i];
+    }
+}
+
+TEST(VpkReadOnly, ReadIntoReusesCallerBuffer)
+{
+    const auto vpkPath = (tempDir("read_into") / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    items.push_back(makeItem("r/big", makePayload(256 * 1024, 1), true));
+    items.push_back(makeItem("r/small", makePayload(3000, 2), true));
+    items.push_back(makeItem("r/stored", makePayload(5000, 3), false));
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, 3)));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+
+    std::ifstream          in(vpkPath, std::ios::binary);
+    std::vector<std::byte> image(std::filesystem::file_size(vpkPath));
+    in.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(image.size()));
+
+    std::vector<std::byte> buffer;
+    ASSERT_TRUE(static_cast<bool>(readVpkFileInto(opened.value(), vpkPath, "r/big", buffer)));
+    EXPECT_EQ(buffer, items[0].bytes);
+
+    // Smaller entries decode into the same allocation, whether compressed or stored, disk or memory.
+    const std::byte* storage = buffer.data();
+    for (const auto& item : items)
+    {
+        ASSERT_TRUE(static_cast<bool>(readVpkFileInto(opened.value(), vpkPath, item.logicalPath, buffer)));
+        EXPECT_EQ(buffer, item.bytes) << item.logicalPath;
+        EXPECT_EQ(buffer.data(), storage) << item.logicalPath;
+
+        ASSERT_TRUE(static_cast<bool>(readVpkFileFromMemoryInto(opened.value(), image, item.logicalPath, buffer)));
+        EXPECT_EQ(buffer, item.bytes) << item.logicalPath;
+        EXPECT_EQ(buffer.data(), storage) << item.logicalPath;
+    }
+
+    auto missing = readVpkFileInto(opened.value(), vpkPath, "r/missing", buffer);
+    ASSERT_FALSE(static_cast<bool>(missing));
+    EXPECT_EQ(missing.error(), AssetError::eNotFound);
+}
+
+TEST(VpkReadOnly, ConcurrentReadsShareOneHandle)
+{
+    const auto vpkPath = (tempDir("concurrent") / "pack.vpk").generic_string();
+
+    std::vector<VpkWriteItem> items;
+    for (uint32_t i = 0; i < 32; ++i)
+        items.push_back(makeItem("e" + std::to_string(i) + ".bin", makePayload(3000 + i * 517, i), (i % 2) == 0));
+    ASSERT_TRUE(static_cast<bool>(writeVpk(vpkPath, items, 3)));
+
+    auto opened = openVpk(vpkPath);
+    ASSERT_TRUE(static_cast<bool>(opened));
+    const VpkReadOnly& vpk = opened.value();
+    ASSERT_NE(vpk.file, nullptr);
+
+    std::vector<std::thread> workers;
+    std::vector<int>         failures(8, 0);
+    for (size_t t = 0; t < failures.size(); ++t)
+    {
+        workers.emplace_back([&, t] {
+            for (int round = 0; round < 20; ++round)
+            {
+                for (size_t i = 0; i < items.size(); ++i)
+                {
+                    const auto& item = items[(i + t * 5) % items.size()];
+                    auto        r    = readVpkFile(vpk, "", item.logicalPath);
+                    if (!r || r.value() != item.bytes)
+                        ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+
+    for (int f : failures)
+        EXPECT_EQ(f, 0);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}